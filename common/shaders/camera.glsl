@@ -0,0 +1,10 @@
+// Per frame data, bound once per frame and shared by every program. Matches
+// FrameUniforms in frame_uniforms.hpp.
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    // Width and height in pixels, then their reciprocals
+    vec4 viewport;
+    // Seconds since start
+    float time;
+};
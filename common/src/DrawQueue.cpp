@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DrawQueue.hpp"
+#include "GlState.hpp"
+
+static constexpr unsigned int depth_bits { 20 };
+
+static std::uint64_t quantize_depth(const float depth) {
+    constexpr float depth_max { (1u << depth_bits) - 1 };
+    return static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * depth_max);
+}
+
+// Constructors
+
+DrawQueue::DrawQueue(const GLenum object_block_target, const unsigned int object_block_binding)
+    : object_block_target { object_block_target }
+    , object_block_binding { object_block_binding }
+    , rasterizer { nullptr } {
+}
+
+DrawQueue::DrawQueue(SoftwareRasterizer& rasterizer)
+    : object_block_target { GL_NONE }
+    , object_block_binding { 0 }
+    , rasterizer { &rasterizer } {
+}
+
+// public
+
+void DrawQueue::set_software_material(
+    const std::uint16_t material,
+    const SoftwareRasterizer::Material& software_material) {
+
+    if (material >= this->software_materials.size()) {
+        this->software_materials.resize(material + 1, software_material);
+    }
+    this->software_materials[material] = software_material;
+}
+
+void DrawQueue::push(const Draw& draw) {
+    this->entries.push_back(SortEntry {
+        .key = make_key(draw),
+        .draw = static_cast<std::uint32_t>(this->draws.size()) });
+    this->draws.push_back(draw);
+}
+
+void DrawQueue::submit() {
+    this->sort();
+
+    if (this->rasterizer != nullptr) {
+        this->submit_software();
+    } else {
+        this->submit_gl();
+    }
+
+    this->draws.clear();
+    this->entries.clear();
+}
+
+std::size_t DrawQueue::size() const {
+    return this->draws.size();
+}
+
+std::uint64_t DrawQueue::make_key(const Draw& draw) {
+    const std::uint64_t pass { static_cast<std::uint64_t>(draw.pass) & 0xF };
+    const std::uint64_t program { draw.program & 0xFFFull };
+    const std::uint64_t material { draw.material };
+    const std::uint64_t vertex_array { draw.vertex_array & 0xFFFull };
+    const std::uint64_t depth { quantize_depth(draw.depth) };
+
+    if (draw.pass == Pass::TRANSLUCENT) {
+        const std::uint64_t inverted_depth { ((1ull << depth_bits) - 1) - depth };
+        return pass << 60 | inverted_depth << 40 | program << 28 | material << 12 | vertex_array;
+    }
+    return pass << 60 | program << 48 | material << 32 | vertex_array << 20 | depth;
+}
+
+// private
+
+// LSD radix sort on the key bytes. Passes over bytes that are equal in every key
+// are skipped, which with few programs and materials is most of them.
+void DrawQueue::sort() {
+    const std::size_t count { this->entries.size() };
+    if (count < 2) {
+        return;
+    }
+
+    this->scratch.resize(count);
+    std::vector<SortEntry>* source { &this->entries };
+    std::vector<SortEntry>* destination { &this->scratch };
+
+    for (unsigned int shift { 0 }; shift < 64; shift += 8) {
+        std::array<std::size_t, 256> offsets {};
+        for (const SortEntry& entry : *source) {
+            offsets[(entry.key >> shift) & 0xFF]++;
+        }
+        if (std::ranges::find(offsets, count) != offsets.end()) {
+            continue;
+        }
+
+        std::size_t offset { 0 };
+        for (std::size_t& bucket : offsets) {
+            const std::size_t bucket_count { bucket };
+            bucket = offset;
+            offset += bucket_count;
+        }
+        for (const SortEntry& entry : *source) {
+            (*destination)[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != &this->entries) {
+        this->entries.swap(this->scratch);
+    }
+}
+
+void DrawQueue::submit_gl() const {
+    GlState& state { gl_state() };
+    for (const SortEntry& entry : this->entries) {
+        const Draw& draw { this->draws[entry.draw] };
+
+        state.use_program(draw.program);
+        for (std::size_t unit { 0 }; unit < max_material_textures; unit++) {
+            if (draw.textures[unit] != 0) {
+                state.bind_texture(unit, GL_TEXTURE_2D, draw.textures[unit]);
+            }
+        }
+        state.bind_vertex_array(draw.vertex_array);
+        if (draw.object_size > 0) {
+            state.bind_buffer_range(this->object_block_target, this->object_block_binding,
+                draw.object_buffer, draw.object_offset, draw.object_size);
+        }
+
+        glDrawElementsInstancedBaseVertex(draw.mode, draw.index_count, draw.index_type,
+            reinterpret_cast<const void*>(draw.index_offset), draw.instance_count,
+            draw.base_vertex);
+    }
+}
+
+void DrawQueue::submit_software() const {
+    for (const SortEntry& entry : this->entries) {
+        const Draw& draw { this->draws[entry.draw] };
+        const SoftwareRasterizer::Material& material { this->software_materials[draw.material] };
+        for (const glm::mat4& model : draw.models) {
+            this->rasterizer->draw(SoftwareRasterizer::Draw {
+                .mesh = draw.mesh, .model = model, .material = material });
+        }
+    }
+}
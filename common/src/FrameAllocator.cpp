@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <format>
+
+#include "glad/glad.h"
+
+#include "FrameAllocator.hpp"
+#include "GlState.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
+
+// Constructors
+
+FrameAllocator::FrameAllocator(const std::size_t frame_size)
+    : _buffer { 0 }
+    , mapped { nullptr }
+    , frame_size { 0 }
+    , alignment { 0 }
+    , fences {}
+    , frame_index { 0 }
+    , frame_used { 0 } {
+
+    int uniform_alignment {};
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+    int storage_alignment {};
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+    this->alignment = static_cast<std::size_t>(std::max({ uniform_alignment, storage_alignment, 16 }));
+
+    // Keep every frame's region aligned too.
+    this->frame_size = (frame_size + this->alignment - 1) / this->alignment * this->alignment;
+
+    constexpr GLbitfield flags { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+    const std::size_t buffer_size { this->frame_size * frame_count };
+
+    glGenBuffers(1, &this->_buffer);
+    gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, this->_buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, buffer_size, nullptr, flags);
+    this->mapped = static_cast<unsigned char*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, buffer_size, flags));
+    gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (this->mapped == nullptr) {
+        log_error("Failed to map frame buffer.");
+        quit(1);
+    }
+}
+
+FrameAllocator::~FrameAllocator() {
+    for (const GLsync fence : this->fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+
+    gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, this->_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+    gl_state().delete_buffer(this->_buffer);
+}
+
+// public
+
+unsigned int FrameAllocator::buffer() const {
+    return this->_buffer;
+}
+
+void FrameAllocator::begin_frame() {
+    GLsync& fence { this->fences[this->frame_index] };
+    if (fence != nullptr) {
+        constexpr GLuint64 timeout_ns { 1'000'000'000 };
+        GLenum status { glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns) };
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, 0, timeout_ns);
+        }
+        if (status == GL_WAIT_FAILED) {
+            log_error("Waiting for frame fence failed.");
+            quit(1);
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    this->frame_used = 0;
+}
+
+void FrameAllocator::end_frame() {
+    this->fences[this->frame_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->frame_index = (this->frame_index + 1) % frame_count;
+}
+
+FrameAllocator::Slice FrameAllocator::allocate(const std::size_t size) {
+    const std::size_t aligned_size { (size + this->alignment - 1) / this->alignment * this->alignment };
+    if (this->frame_used + aligned_size > this->frame_size) {
+        log_error(std::format("Frame allocator out of memory, {} of {} bytes used.",
+            this->frame_used, this->frame_size)
+                .c_str());
+        quit(1);
+    }
+
+    const std::size_t offset { this->frame_index * this->frame_size + this->frame_used };
+    this->frame_used += aligned_size;
+
+    return Slice {
+        .offset = offset,
+        .size = size,
+        .data = this->mapped + offset
+    };
+}
+
+void FrameAllocator::bind(
+    const FrameAllocator::Slice& slice,
+    const GLenum target,
+    const unsigned int binding) const {
+
+    gl_state().bind_buffer_range(target, binding, this->_buffer, slice.offset, slice.size);
+}
@@ -0,0 +1,29 @@
+#include <glm/glm.hpp>
+
+#include "Frustum.hpp"
+
+Frustum Frustum::from_view_projection(const glm::mat4& view_projection) {
+    // Rows of the matrix, glm stores columns.
+    std::array<glm::vec4, 4> rows {};
+    for (int row { 0 }; row < 4; row++) {
+        rows[row] = glm::vec4 {
+            view_projection[0][row],
+            view_projection[1][row],
+            view_projection[2][row],
+            view_projection[3][row] };
+    }
+
+    Frustum frustum {};
+    frustum.planes[LEFT] = rows[3] + rows[0];
+    frustum.planes[RIGHT] = rows[3] - rows[0];
+    frustum.planes[BOTTOM] = rows[3] + rows[1];
+    frustum.planes[TOP] = rows[3] - rows[1];
+    frustum.planes[NEAR] = rows[3] + rows[2];
+    frustum.planes[FAR] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3 { plane });
+    }
+
+    return frustum;
+}
@@ -0,0 +1,258 @@
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "GlState.hpp"
+
+// Position of value in a target table, or the table's size for targets that are
+// not shadowed and are always issued.
+template <typename Table>
+static std::size_t index_of(const Table& table, const GLenum value) {
+    return std::ranges::find(table, value) - table.begin();
+}
+
+// Constructors
+
+GlState::GlState()
+    : _counters {} {
+
+    this->invalidate();
+}
+
+// public
+
+void GlState::invalidate() {
+    constexpr BufferRange unknown_range { .buffer = unknown, .offset = -1, .size = -1 };
+
+    this->program = unknown;
+    this->vertex_array = unknown;
+    this->buffers.fill(unknown);
+    this->uniform_buffers.fill(unknown_range);
+    this->storage_buffers.fill(unknown_range);
+    this->active_texture_unit = unknown;
+    for (auto& unit_textures : this->textures) {
+        unit_textures.fill(unknown);
+    }
+    this->samplers.fill(unknown);
+
+    this->enabled.fill(Toggle::UNKNOWN);
+    this->blend_factors.fill(unknown);
+    this->_depth_func = unknown;
+    this->_depth_mask = Toggle::UNKNOWN;
+    this->_viewport.fill(-1);
+}
+
+const GlState::Counters& GlState::counters() const {
+    return this->_counters;
+}
+
+void GlState::reset_counters() {
+    this->_counters = {};
+}
+
+void GlState::use_program(const unsigned int program) {
+    if (this->changes(this->program != program)) {
+        glUseProgram(program);
+        this->program = program;
+    }
+}
+
+void GlState::bind_vertex_array(const unsigned int vertex_array) {
+    if (this->changes(this->vertex_array != vertex_array)) {
+        glBindVertexArray(vertex_array);
+        this->vertex_array = vertex_array;
+        // The element array binding is part of the vertex array.
+        this->buffers[index_of(buffer_targets, GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+    }
+}
+
+void GlState::bind_buffer(const GLenum target, const unsigned int buffer) {
+    const std::size_t slot { index_of(buffer_targets, target) };
+    if (slot == buffer_targets.size()) {
+        this->changes(true);
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (this->changes(this->buffers[slot] != buffer)) {
+        glBindBuffer(target, buffer);
+        this->buffers[slot] = buffer;
+    }
+}
+
+void GlState::bind_buffer_range(
+    const GLenum target,
+    const unsigned int index,
+    const unsigned int buffer,
+    const GLintptr offset,
+    const GLsizeiptr size) {
+
+    std::array<BufferRange, max_indexed_buffer_bindings>* ranges { nullptr };
+    if (target == GL_UNIFORM_BUFFER) {
+        ranges = &this->uniform_buffers;
+    } else if (target == GL_SHADER_STORAGE_BUFFER) {
+        ranges = &this->storage_buffers;
+    }
+
+    if (ranges == nullptr || index >= max_indexed_buffer_bindings) {
+        this->changes(true);
+        glBindBufferRange(target, index, buffer, offset, size);
+        const std::size_t slot { index_of(buffer_targets, target) };
+        if (slot < buffer_targets.size()) {
+            this->buffers[slot] = unknown;
+        }
+        return;
+    }
+
+    BufferRange& range { (*ranges)[index] };
+    if (this->changes(range.buffer != buffer || range.offset != offset || range.size != size)) {
+        glBindBufferRange(target, index, buffer, offset, size);
+        range = BufferRange { .buffer = buffer, .offset = offset, .size = size };
+        // Also binds the generic binding point of the target.
+        this->buffers[index_of(buffer_targets, target)] = buffer;
+    }
+}
+
+void GlState::bind_texture(
+    const unsigned int unit,
+    const GLenum target,
+    const unsigned int texture) {
+
+    const std::size_t slot { index_of(texture_targets, target) };
+    if (unit >= max_texture_units || slot == texture_targets.size()) {
+        this->changes(true);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        this->active_texture_unit = unit;
+        if (unit < max_texture_units) {
+            this->textures[unit].fill(unknown);
+        }
+        return;
+    }
+
+    unsigned int& bound { this->textures[unit][slot] };
+    if (this->changes(bound != texture)) {
+        this->activate_texture_unit(unit);
+        glBindTexture(target, texture);
+        bound = texture;
+    }
+}
+
+void GlState::bind_sampler(const unsigned int unit, const unsigned int sampler) {
+    if (unit >= max_texture_units) {
+        this->changes(true);
+        glBindSampler(unit, sampler);
+        return;
+    }
+
+    if (this->changes(this->samplers[unit] != sampler)) {
+        glBindSampler(unit, sampler);
+        this->samplers[unit] = sampler;
+    }
+}
+
+void GlState::set_enabled(const GLenum capability, const bool enabled) {
+    const std::size_t slot { index_of(capabilities, capability) };
+    const Toggle toggle { enabled ? Toggle::ON : Toggle::OFF };
+    if (slot == capabilities.size()) {
+        this->changes(true);
+    } else if (this->changes(this->enabled[slot] != toggle)) {
+        this->enabled[slot] = toggle;
+    } else {
+        return;
+    }
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void GlState::blend_func(const GLenum source_factor, const GLenum destination_factor) {
+    const std::array<GLenum, 2> factors { source_factor, destination_factor };
+    if (this->changes(this->blend_factors != factors)) {
+        glBlendFunc(source_factor, destination_factor);
+        this->blend_factors = factors;
+    }
+}
+
+void GlState::depth_func(const GLenum func) {
+    if (this->changes(this->_depth_func != func)) {
+        glDepthFunc(func);
+        this->_depth_func = func;
+    }
+}
+
+void GlState::depth_mask(const bool enabled) {
+    const Toggle toggle { enabled ? Toggle::ON : Toggle::OFF };
+    if (this->changes(this->_depth_mask != toggle)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        this->_depth_mask = toggle;
+    }
+}
+
+void GlState::viewport(const int x, const int y, const int width, const int height) {
+    const std::array<int, 4> viewport { x, y, width, height };
+    if (this->changes(this->_viewport != viewport)) {
+        glViewport(x, y, width, height);
+        this->_viewport = viewport;
+    }
+}
+
+void GlState::delete_program(const unsigned int program) {
+    glDeleteProgram(program);
+    if (this->program == program) {
+        this->program = unknown;
+    }
+}
+
+void GlState::delete_vertex_array(const unsigned int vertex_array) {
+    glDeleteVertexArrays(1, &vertex_array);
+    if (this->vertex_array == vertex_array) {
+        this->vertex_array = unknown;
+        this->buffers[index_of(buffer_targets, GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+    }
+}
+
+void GlState::delete_buffer(const unsigned int buffer) {
+    glDeleteBuffers(1, &buffer);
+    std::ranges::replace(this->buffers, buffer, unknown);
+    for (auto* ranges : { &this->uniform_buffers, &this->storage_buffers }) {
+        for (BufferRange& range : *ranges) {
+            if (range.buffer == buffer) {
+                range.buffer = unknown;
+            }
+        }
+    }
+}
+
+void GlState::delete_texture(const unsigned int texture) {
+    glDeleteTextures(1, &texture);
+    for (auto& unit_textures : this->textures) {
+        std::ranges::replace(unit_textures, texture, unknown);
+    }
+}
+
+// private
+
+bool GlState::changes(const bool changed) {
+    if (changed) {
+        this->_counters.issued++;
+    } else {
+        this->_counters.elided++;
+    }
+    return changed;
+}
+
+void GlState::activate_texture_unit(const unsigned int unit) {
+    if (this->active_texture_unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        this->active_texture_unit = unit;
+    }
+}
+
+GlState& gl_state() {
+    thread_local GlState state {};
+    return state;
+}
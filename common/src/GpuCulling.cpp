@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "GlState.hpp"
+#include "GpuCulling.hpp"
+
+static unsigned int create_storage_buffer(const std::size_t size, const void* data) {
+    unsigned int buffer {};
+    glGenBuffers(1, &buffer);
+    gl_state().bind_buffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_STORAGE_BIT);
+    gl_state().bind_buffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+// Constructors
+
+GpuCulling::GpuCulling(Shader& program, const std::span<const Object> objects)
+    : program { program }
+    , planes_uniform { this->program.get_uniform<glm::vec4>("planes") }
+    , object_count_uniform { this->program.get_uniform<int>("object_count") }
+    , object_count { objects.size() } {
+
+    // Buffers may not be empty.
+    const std::size_t capacity { std::max<std::size_t>(this->object_count, 1) };
+    this->object_buffer = create_storage_buffer(capacity * sizeof(Object), nullptr);
+    if (!objects.empty()) {
+        glNamedBufferSubData(this->object_buffer, 0, objects.size_bytes(), objects.data());
+    }
+    this->command_buffer = create_storage_buffer(
+        capacity * sizeof(MeshPool::DrawElementsIndirectCommand), nullptr);
+    this->visible_model_buffer = create_storage_buffer(capacity * sizeof(glm::mat4), nullptr);
+    this->draw_count_buffer = create_storage_buffer(sizeof(std::uint32_t), nullptr);
+}
+
+GpuCulling::~GpuCulling() {
+    gl_state().delete_buffer(this->object_buffer);
+    gl_state().delete_buffer(this->command_buffer);
+    gl_state().delete_buffer(this->visible_model_buffer);
+    gl_state().delete_buffer(this->draw_count_buffer);
+}
+
+// public
+
+GpuCulling::Object GpuCulling::make_object(
+    const MeshPool::Range& range,
+    const glm::mat4& model,
+    const float radius) {
+
+    return Object {
+        .sphere = glm::vec4 { glm::vec3 { model[3] }, radius },
+        .index_count = range.index_count,
+        .first_index = range.first_index,
+        .base_vertex = range.base_vertex,
+        .padding = 0,
+        .model = model
+    };
+}
+
+void GpuCulling::cull(const Frustum& frustum) {
+    const std::uint32_t zero { 0 };
+    glClearNamedBufferData(this->draw_count_buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT,
+        &zero);
+
+    // Set every time, a reloaded program starts with default values.
+    this->program.set_int(this->object_count_uniform, static_cast<int>(this->object_count));
+    this->program.set_vec4(this->planes_uniform, frustum.planes);
+    this->program.use();
+
+    GlState& state { gl_state() };
+    const std::size_t capacity { std::max<std::size_t>(this->object_count, 1) };
+    state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, visible_model_binding,
+        this->visible_model_buffer, 0, capacity * sizeof(glm::mat4));
+    state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, object_binding,
+        this->object_buffer, 0, capacity * sizeof(Object));
+    state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, command_binding,
+        this->command_buffer, 0, capacity * sizeof(MeshPool::DrawElementsIndirectCommand));
+    state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, draw_count_binding,
+        this->draw_count_buffer, 0, sizeof(std::uint32_t));
+
+    const std::size_t group_count { (this->object_count + workgroup_size - 1) / workgroup_size };
+    glDispatchCompute(static_cast<unsigned int>(group_count), 1, 1);
+
+    // The commands and the count are read as indirect parameters, the models by
+    // the vertex shader.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCulling::draw(const MeshPool& mesh_pool) const {
+    const std::size_t capacity { std::max<std::size_t>(this->object_count, 1) };
+    gl_state().bind_buffer_range(GL_SHADER_STORAGE_BUFFER, visible_model_binding,
+        this->visible_model_buffer, 0, capacity * sizeof(glm::mat4));
+    mesh_pool.multi_draw_count(this->command_buffer, 0, this->draw_count_buffer, 0,
+        static_cast<GLsizei>(this->object_count));
+}
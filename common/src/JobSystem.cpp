@@ -0,0 +1,267 @@
+#include "JobSystem.hpp"
+
+// Worker of the job system the calling thread belongs to, if any.
+static thread_local const JobSystem* current_system { nullptr };
+static thread_local unsigned int current_worker { 0 };
+
+// Counter
+
+bool JobSystem::Counter::done() const {
+    return this->pending.load(std::memory_order_acquire) == 0;
+}
+
+// WorkDeque
+
+bool JobSystem::WorkDeque::push(Job* job) {
+    const std::int64_t bottom { this->bottom.load(std::memory_order_relaxed) };
+    const std::int64_t top { this->top.load(std::memory_order_acquire) };
+    if (bottom - top >= capacity) {
+        return false;
+    }
+
+    this->jobs[bottom & (capacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job* JobSystem::WorkDeque::pop() {
+    const std::int64_t bottom { this->bottom.load(std::memory_order_relaxed) - 1 };
+    this->bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top { this->top.load(std::memory_order_relaxed) };
+
+    if (top > bottom) {
+        // Empty
+        this->bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job { this->jobs[bottom & (capacity - 1)].load(std::memory_order_relaxed) };
+    if (top == bottom) {
+        // The last job, a thief may be taking it as well.
+        if (!this->top.compare_exchange_strong(top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        this->bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job* JobSystem::WorkDeque::steal() {
+    std::int64_t top { this->top.load(std::memory_order_acquire) };
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom { this->bottom.load(std::memory_order_acquire) };
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    Job* job { this->jobs[top & (capacity - 1)].load(std::memory_order_relaxed) };
+    if (!this->top.compare_exchange_strong(top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+// Constructors
+
+JobSystem::JobSystem(unsigned int worker_count)
+    : deques { std::make_unique<WorkDeque[]>(std::max(worker_count, 1u)) }
+    , _worker_count { std::max(worker_count, 1u) }
+    , work_epoch { 0 }
+    , stopping { false } {
+
+    this->workers.reserve(this->_worker_count);
+    for (unsigned int worker { 0 }; worker < this->_worker_count; worker++) {
+        this->workers.emplace_back([this, worker]() { this->work(worker); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    this->stopping = true;
+    this->work_epoch.fetch_add(1);
+    this->work_epoch.notify_all();
+    this->workers.clear();
+}
+
+// public
+
+unsigned int JobSystem::worker_count() const {
+    return this->_worker_count;
+}
+
+void JobSystem::submit(Function function, Counter* counter) {
+    if (counter != nullptr) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->enqueue(new Job { .function = std::move(function), .counter = counter });
+}
+
+void JobSystem::submit_after(Counter& dependency, Function function, Counter* counter) {
+    if (counter != nullptr) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* job { new Job { .function = std::move(function), .counter = counter } };
+
+    {
+        std::lock_guard lock { dependency.continuations_mutex };
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            // Queued by the job that finishes the dependency
+            dependency.continuations.push_back([this, job]() { this->enqueue(job); });
+            return;
+        }
+    }
+    this->enqueue(job);
+}
+
+void JobSystem::submit_background(Function function, Counter* counter) {
+    if (counter != nullptr) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* job { new Job { .function = std::move(function), .counter = counter } };
+
+    {
+        std::lock_guard lock { this->shared_mutex };
+        this->background_jobs.push_back(job);
+    }
+    this->work_epoch.fetch_add(1, std::memory_order_release);
+    this->work_epoch.notify_one();
+}
+
+void JobSystem::wait(const Counter& counter) {
+    while (true) {
+        const std::uint32_t pending { counter.pending.load(std::memory_order_acquire) };
+        if (pending == 0) {
+            break;
+        }
+        if (Job* job { this->find_job() }; job != nullptr) {
+            this->run(job);
+            continue;
+        }
+        // The jobs left are running elsewhere, in the background queue or not
+        // queued yet. run() wakes us when the last one finishes.
+        counter.pending.wait(pending, std::memory_order_acquire);
+    }
+
+    // The job that finished the counter may still hold its lock, the caller is
+    // free to destroy the counter once it is released.
+    std::lock_guard lock { const_cast<Counter&>(counter).continuations_mutex };
+}
+
+unsigned int JobSystem::default_worker_count() {
+    // The submitting thread helps while it waits.
+    const unsigned int cores { std::thread::hardware_concurrency() };
+    return cores > 1 ? cores - 1 : 1;
+}
+
+// private
+
+void JobSystem::enqueue(Job* job) {
+    const bool pushed {
+        current_system == this && this->deques[current_worker].push(job)
+    };
+    if (!pushed) {
+        std::lock_guard lock { this->shared_mutex };
+        this->shared_jobs.push_back(job);
+    }
+
+    this->work_epoch.fetch_add(1, std::memory_order_release);
+    this->work_epoch.notify_one();
+}
+
+JobSystem::Job* JobSystem::find_job() {
+    const bool is_worker { current_system == this };
+
+    // Own jobs first, newest first so their data is still in cache
+    if (is_worker) {
+        if (Job* job { this->deques[current_worker].pop() }; job != nullptr) {
+            return job;
+        }
+    }
+
+    {
+        std::lock_guard lock { this->shared_mutex };
+        if (!this->shared_jobs.empty()) {
+            Job* job { this->shared_jobs.front() };
+            this->shared_jobs.pop_front();
+            return job;
+        }
+    }
+
+    // Then the oldest job of another worker
+    const unsigned int first { is_worker ? current_worker + 1 : 0 };
+    for (unsigned int offset { 0 }; offset < this->_worker_count; offset++) {
+        const unsigned int victim { (first + offset) % this->_worker_count };
+        if (is_worker && victim == current_worker) {
+            continue;
+        }
+        if (Job* job { this->deques[victim].steal() }; job != nullptr) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+JobSystem::Job* JobSystem::find_background_job() {
+    std::lock_guard lock { this->shared_mutex };
+    if (this->background_jobs.empty()) {
+        return nullptr;
+    }
+    Job* job { this->background_jobs.front() };
+    this->background_jobs.pop_front();
+    return job;
+}
+
+void JobSystem::run(Job* job) {
+    const std::unique_ptr<Job> owned { job };
+    owned->function();
+
+    Counter* counter { owned->counter };
+    if (counter == nullptr) {
+        return;
+    }
+
+    // Decremented under the lock so submit_after never misses the last job, and
+    // the waiters are woken under it so the counter outlives the notify.
+    std::vector<Function> continuations;
+    {
+        std::lock_guard lock { counter->continuations_mutex };
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuations = std::move(counter->continuations);
+            counter->continuations.clear();
+            counter->pending.notify_all();
+        }
+    }
+    for (Function& continuation : continuations) {
+        continuation();
+    }
+}
+
+void JobSystem::work(const unsigned int worker) {
+    current_system = this;
+    current_worker = worker;
+
+    while (true) {
+        const std::uint32_t epoch { this->work_epoch.load(std::memory_order_acquire) };
+        if (Job* job { this->find_job() }; job != nullptr) {
+            this->run(job);
+            continue;
+        }
+        if (Job* job { this->find_background_job() }; job != nullptr) {
+            this->run(job);
+            continue;
+        }
+        // Queued jobs are drained before stopping.
+        if (this->stopping) {
+            return;
+        }
+        this->work_epoch.wait(epoch, std::memory_order_acquire);
+    }
+}
+
+JobSystem& job_system() {
+    static JobSystem system {};
+    return system;
+}
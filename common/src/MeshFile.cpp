@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "GlState.hpp"
+#include "MeshFile.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
+
+static std::uint64_t align_up(const std::uint64_t value) {
+    return (value + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment;
+}
+
+// Sizes are checked by division so huge counts cannot wrap around.
+static bool is_valid_blob(
+    const std::uint64_t offset,
+    const std::uint64_t size,
+    const std::uint64_t count,
+    const std::uint64_t element_size,
+    const std::size_t file_size) {
+
+    return count > 0
+        && element_size > 0
+        && offset % mesh_file_alignment == 0
+        && size % element_size == 0
+        && size / element_size == count
+        && offset <= file_size
+        && size <= file_size - offset;
+}
+
+static bool is_valid(const std::byte* mapped, const std::size_t file_size) {
+    const MeshFileHeader& header { *reinterpret_cast<const MeshFileHeader*>(mapped) };
+    if (header.magic != mesh_file_magic || header.version != mesh_file_version) {
+        return false;
+    }
+
+    const std::uint64_t attributes_end {
+        sizeof(MeshFileHeader) + std::uint64_t { header.attribute_count } * sizeof(MeshFileAttribute)
+    };
+    if (header.attribute_count == 0 || attributes_end > file_size
+        || header.vertex_offset < attributes_end) {
+        return false;
+    }
+
+    const MeshFileAttribute* attributes {
+        reinterpret_cast<const MeshFileAttribute*>(mapped + sizeof(MeshFileHeader))
+    };
+    for (std::uint32_t i { 0 }; i < header.attribute_count; i++) {
+        const MeshFileAttribute& attribute { attributes[i] };
+        if (attribute.component_count < 1 || attribute.component_count > 4
+            || attribute.component_type != GL_FLOAT
+            || std::uint64_t { attribute.offset } + attribute.component_count * sizeof(float)
+                > header.vertex_stride) {
+            return false;
+        }
+    }
+
+    const bool known_index_type {
+        header.index_type == GL_UNSIGNED_BYTE
+        || header.index_type == GL_UNSIGNED_SHORT
+        || header.index_type == GL_UNSIGNED_INT
+    };
+    // Index counts are passed to GL as GLsizei.
+    return known_index_type
+        && header.index_count <= static_cast<std::uint64_t>(std::numeric_limits<GLsizei>::max())
+        && is_valid_blob(header.vertex_offset, header.vertex_size, header.vertex_count,
+            header.vertex_stride, file_size)
+        && is_valid_blob(header.index_offset, header.index_size, header.index_count,
+            index_type_size(header.index_type), file_size);
+}
+
+bool write_mesh_file(
+    const std::filesystem::path& path,
+    const Mesh& mesh,
+    const std::span<const int> attribute_sizes) {
+
+    std::vector<MeshFileAttribute> attributes;
+    std::uint32_t offset { 0 };
+    for (const int size : attribute_sizes) {
+        attributes.push_back(MeshFileAttribute {
+            .component_count = static_cast<std::uint32_t>(size),
+            .component_type = GL_FLOAT,
+            .offset = offset,
+            .padding = 0 });
+        offset += static_cast<std::uint32_t>(size) * sizeof(float);
+    }
+
+    MeshFileHeader header {
+        .magic = mesh_file_magic,
+        .version = mesh_file_version,
+        .attribute_count = static_cast<std::uint32_t>(attributes.size()),
+        .vertex_stride = static_cast<std::uint32_t>(mesh.floats_per_vertex * sizeof(float)),
+        .vertex_count = mesh.vertex_count,
+        .index_count = mesh.index_count,
+        .index_type = mesh.index_type,
+        .padding = 0,
+        .vertex_offset = 0,
+        .vertex_size = mesh.vertices.size() * sizeof(float),
+        .index_offset = 0,
+        .index_size = mesh.indices.size(),
+        .bounds_min = { 0.0f, 0.0f, 0.0f },
+        .bounds_max = { 0.0f, 0.0f, 0.0f }
+    };
+    header.vertex_offset = align_up(sizeof(header) + attributes.size() * sizeof(MeshFileAttribute));
+    header.index_offset = align_up(header.vertex_offset + header.vertex_size);
+
+    if (mesh.vertex_count > 0 && mesh.floats_per_vertex >= 3) {
+        std::ranges::fill(header.bounds_min, std::numeric_limits<float>::max());
+        std::ranges::fill(header.bounds_max, std::numeric_limits<float>::lowest());
+        for (std::size_t vertex { 0 }; vertex < mesh.vertex_count; vertex++) {
+            for (std::size_t axis { 0 }; axis < 3; axis++) {
+                const float value { mesh.vertices[vertex * mesh.floats_per_vertex + axis] };
+                header.bounds_min[axis] = std::min(header.bounds_min[axis], value);
+                header.bounds_max[axis] = std::max(header.bounds_max[axis], value);
+            }
+        }
+    }
+
+    std::ofstream file { path, std::ios::binary };
+    if (!file) {
+        return false;
+    }
+
+    const auto pad_to { [&file](const std::uint64_t offset) {
+        constexpr char zeros[mesh_file_alignment] {};
+        const std::uint64_t position { static_cast<std::uint64_t>(file.tellp()) };
+        file.write(zeros, static_cast<std::streamsize>(offset - position));
+    } };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(attributes.data()),
+        static_cast<std::streamsize>(attributes.size() * sizeof(MeshFileAttribute)));
+    pad_to(header.vertex_offset);
+    file.write(reinterpret_cast<const char*>(mesh.vertices.data()),
+        static_cast<std::streamsize>(header.vertex_size));
+    pad_to(header.index_offset);
+    file.write(reinterpret_cast<const char*>(mesh.indices.data()),
+        static_cast<std::streamsize>(header.index_size));
+    return static_cast<bool>(file);
+}
+
+// Constructors
+
+MappedMesh::MappedMesh(const std::filesystem::path& path)
+    : mapped { nullptr }
+    , size { 0 } {
+
+    const int file { open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+    if (file == -1) {
+        log_error(std::format("Failed to open mesh file '{}'.", path.c_str()).c_str());
+        quit(1);
+    }
+
+    struct stat status {};
+    if (fstat(file, &status) == -1 || static_cast<std::size_t>(status.st_size) < sizeof(MeshFileHeader)) {
+        close(file);
+        log_error(std::format("'{}' is not a mesh file.", path.c_str()).c_str());
+        quit(1);
+    }
+    this->size = static_cast<std::size_t>(status.st_size);
+
+    void* mapping { mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file, 0) };
+    // The mapping keeps the file alive.
+    close(file);
+    if (mapping == MAP_FAILED) {
+        log_error(std::format("Failed to map mesh file '{}'.", path.c_str()).c_str());
+        quit(1);
+    }
+    this->mapped = static_cast<const std::byte*>(mapping);
+
+    if (!is_valid(this->mapped, this->size)) {
+        log_error(std::format("'{}' is not a valid mesh file.", path.c_str()).c_str());
+        quit(1);
+    }
+
+    // Every page is read by the upload right away.
+    madvise(mapping, this->size, MADV_WILLNEED);
+}
+
+MappedMesh::~MappedMesh() {
+    munmap(const_cast<std::byte*>(this->mapped), this->size);
+}
+
+MeshBuffers::MeshBuffers(const MappedMesh& mesh)
+    : _vertex_array { 0 }
+    , vertex_buffer { 0 }
+    , index_buffer { 0 }
+    , _index_count { static_cast<GLsizei>(mesh.header().index_count) }
+    , _index_type { mesh.header().index_type } {
+
+    // Limits of the driver, the file itself was checked when it was mapped.
+    GLint max_attributes {};
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+    GLint max_stride {};
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIB_STRIDE, &max_stride);
+    if (mesh.header().attribute_count > static_cast<std::uint32_t>(max_attributes)
+        || mesh.header().vertex_stride > static_cast<std::uint32_t>(max_stride)) {
+        log_error(std::format("Mesh with {} attributes and a {} byte stride exceeds the "
+                              "limits of the GL driver.",
+            mesh.header().attribute_count, mesh.header().vertex_stride)
+                .c_str());
+        quit(1);
+    }
+
+    // Immutable storage filled straight from the mapped pages
+    const std::span<const std::byte> vertices { mesh.vertices() };
+    glCreateBuffers(1, &this->vertex_buffer);
+    glNamedBufferStorage(this->vertex_buffer, static_cast<GLsizeiptr>(vertices.size()),
+        vertices.data(), 0);
+
+    const std::span<const std::byte> indices { mesh.indices() };
+    glCreateBuffers(1, &this->index_buffer);
+    glNamedBufferStorage(this->index_buffer, static_cast<GLsizeiptr>(indices.size()),
+        indices.data(), 0);
+
+    glCreateVertexArrays(1, &this->_vertex_array);
+    glVertexArrayVertexBuffer(this->_vertex_array, 0, this->vertex_buffer, 0,
+        static_cast<GLsizei>(mesh.header().vertex_stride));
+    glVertexArrayElementBuffer(this->_vertex_array, this->index_buffer);
+
+    const std::span<const MeshFileAttribute> attributes { mesh.attributes() };
+    for (unsigned int attrib_index { 0 }; attrib_index < attributes.size(); attrib_index++) {
+        const MeshFileAttribute& attribute { attributes[attrib_index] };
+        glVertexArrayAttribFormat(this->_vertex_array, attrib_index,
+            static_cast<GLint>(attribute.component_count), attribute.component_type, GL_FALSE,
+            attribute.offset);
+        glVertexArrayAttribBinding(this->_vertex_array, attrib_index, 0);
+        glEnableVertexArrayAttrib(this->_vertex_array, attrib_index);
+    }
+}
+
+MeshBuffers::~MeshBuffers() {
+    gl_state().delete_vertex_array(this->_vertex_array);
+    gl_state().delete_buffer(this->vertex_buffer);
+    gl_state().delete_buffer(this->index_buffer);
+}
+
+// public
+
+const MeshFileHeader& MappedMesh::header() const {
+    return *reinterpret_cast<const MeshFileHeader*>(this->mapped);
+}
+
+std::span<const MeshFileAttribute> MappedMesh::attributes() const {
+    return std::span {
+        reinterpret_cast<const MeshFileAttribute*>(this->mapped + sizeof(MeshFileHeader)),
+        this->header().attribute_count
+    };
+}
+
+std::span<const std::byte> MappedMesh::vertices() const {
+    return std::span { this->mapped + this->header().vertex_offset, this->header().vertex_size };
+}
+
+std::span<const std::byte> MappedMesh::indices() const {
+    return std::span { this->mapped + this->header().index_offset, this->header().index_size };
+}
+
+unsigned int MeshBuffers::vertex_array() const {
+    return this->_vertex_array;
+}
+
+GLsizei MeshBuffers::index_count() const {
+    return this->_index_count;
+}
+
+GLenum MeshBuffers::index_type() const {
+    return this->_index_type;
+}
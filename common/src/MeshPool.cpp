@@ -0,0 +1,129 @@
+#include <cstring>
+#include <format>
+#include <numeric>
+#include <vector>
+
+#include "GlState.hpp"
+#include "MeshPool.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
+
+template <typename T>
+static void widen_indices(const std::span<const std::byte> indices, std::span<std::uint32_t> wide) {
+    for (std::size_t i { 0 }; i < wide.size(); i++) {
+        T index {};
+        std::memcpy(&index, indices.data() + i * sizeof(T), sizeof(T));
+        wide[i] = index;
+    }
+}
+
+// Constructors
+
+MeshPool::MeshPool(
+    const std::span<const int> attribute_sizes,
+    const std::size_t max_vertices,
+    const std::size_t max_indices)
+    : _vertex_array { 0 }
+    , vertex_buffer { 0 }
+    , index_buffer { 0 }
+    , floats_per_vertex { static_cast<std::size_t>(
+          std::accumulate(attribute_sizes.begin(), attribute_sizes.end(), 0)) }
+    , max_vertices { max_vertices }
+    , max_indices { max_indices }
+    , vertex_count { 0 }
+    , index_count { 0 } {
+
+    glGenVertexArrays(1, &this->_vertex_array);
+    gl_state().bind_vertex_array(this->_vertex_array);
+
+    glGenBuffers(1, &this->vertex_buffer);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, max_vertices * this->floats_per_vertex * sizeof(float),
+        nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    glGenBuffers(1, &this->index_buffer);
+    gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->index_buffer);
+    glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, max_indices * sizeof(std::uint32_t), nullptr,
+        GL_DYNAMIC_STORAGE_BIT);
+
+    const std::size_t stride { this->floats_per_vertex * sizeof(float) };
+    std::size_t offset { 0 };
+    for (unsigned int attrib_index { 0 }; attrib_index < attribute_sizes.size(); attrib_index++) {
+        glVertexAttribPointer(attrib_index, attribute_sizes[attrib_index], GL_FLOAT, GL_FALSE,
+            stride, reinterpret_cast<const void*>(offset));
+        glEnableVertexAttribArray(attrib_index);
+        offset += attribute_sizes[attrib_index] * sizeof(float);
+    }
+
+    gl_state().bind_vertex_array(0);
+    gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshPool::~MeshPool() {
+    gl_state().delete_vertex_array(this->_vertex_array);
+    gl_state().delete_buffer(this->vertex_buffer);
+    gl_state().delete_buffer(this->index_buffer);
+}
+
+// public
+
+unsigned int MeshPool::vertex_array() const {
+    return this->_vertex_array;
+}
+
+MeshPool::Range MeshPool::add(const Mesh& mesh) {
+    if (mesh.floats_per_vertex != this->floats_per_vertex) {
+        log_error(std::format("Mesh has {} floats per vertex, the pool {}.",
+            mesh.floats_per_vertex, this->floats_per_vertex).c_str());
+        quit(1);
+    }
+    if (this->vertex_count + mesh.vertex_count > this->max_vertices
+        || this->index_count + mesh.index_count > this->max_indices) {
+        log_error("Mesh pool is full.");
+        quit(1);
+    }
+
+    std::vector<std::uint32_t> indices(mesh.index_count);
+    switch (mesh.index_type) {
+    case GL_UNSIGNED_BYTE:
+        widen_indices<std::uint8_t>(mesh.indices, indices);
+        break;
+    case GL_UNSIGNED_SHORT:
+        widen_indices<std::uint16_t>(mesh.indices, indices);
+        break;
+    default:
+        widen_indices<std::uint32_t>(mesh.indices, indices);
+        break;
+    }
+
+    const Range range {
+        .first_index = static_cast<std::uint32_t>(this->index_count),
+        .index_count = static_cast<std::uint32_t>(mesh.index_count),
+        .base_vertex = static_cast<std::int32_t>(this->vertex_count)
+    };
+
+    glNamedBufferSubData(this->vertex_buffer,
+        this->vertex_count * this->floats_per_vertex * sizeof(float),
+        mesh.vertices.size() * sizeof(float), mesh.vertices.data());
+    glNamedBufferSubData(this->index_buffer, this->index_count * sizeof(std::uint32_t),
+        indices.size() * sizeof(std::uint32_t), indices.data());
+
+    this->vertex_count += mesh.vertex_count;
+    this->index_count += mesh.index_count;
+    return range;
+}
+
+void MeshPool::multi_draw_count(
+    const unsigned int command_buffer,
+    const std::size_t offset,
+    const unsigned int count_buffer,
+    const std::size_t count_offset,
+    const GLsizei max_draw_count) const {
+
+    gl_state().bind_vertex_array(this->_vertex_array);
+    gl_state().bind_buffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+    gl_state().bind_buffer(GL_PARAMETER_BUFFER, count_buffer);
+    glMultiDrawElementsIndirectCount(GL_TRIANGLES, index_type,
+        reinterpret_cast<const void*>(offset), static_cast<GLintptr>(count_offset),
+        max_draw_count, 0);
+}
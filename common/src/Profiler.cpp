@@ -0,0 +1,261 @@
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "glad/glad.h"
+
+#include "Profiler.hpp"
+#include "error_handling.hpp"
+
+// Trace thread id of the GPU timeline, CPU threads are numbered from 1.
+static constexpr std::uint32_t gpu_thread_id { 0 };
+
+// Zones recorded on one thread. Only that thread pushes and only end_frame() pops,
+// so the indices are the sole synchronization. Zones are dropped when it is full.
+struct ThreadZones {
+    static constexpr std::size_t capacity { 4096 };
+
+    std::array<ProfileEvent, capacity> zones;
+    std::atomic<std::size_t> head { 0 };
+    std::atomic<std::size_t> tail { 0 };
+    std::atomic<std::size_t> dropped { 0 };
+    std::uint32_t thread_id;
+};
+
+static std::atomic<bool> profiling_enabled { false };
+static const std::chrono::steady_clock::time_point profiler_epoch {
+    std::chrono::steady_clock::now()
+};
+
+// Guards registration only, the buffers outlive their threads.
+static std::mutex thread_zones_mutex;
+static std::vector<std::unique_ptr<ThreadZones>> thread_zones;
+
+static ThreadZones& local_thread_zones() {
+    thread_local ThreadZones* zones { nullptr };
+    if (zones == nullptr) {
+        std::lock_guard lock { thread_zones_mutex };
+        thread_zones.push_back(std::make_unique<ThreadZones>());
+        zones = thread_zones.back().get();
+        zones->thread_id = thread_zones.size();
+    }
+    return *zones;
+}
+
+// Constructors
+
+Profiler::Profiler(const bool enabled, const bool gpu_zones)
+    : gpu_zones { enabled && gpu_zones }
+    , query_pools {}
+    , query_pool_index { 0 }
+    , gpu_to_cpu_offset_ns { 0 }
+    , dropped_gpu_frames { 0 } {
+
+    profiling_enabled.store(enabled, std::memory_order_relaxed);
+    if (!this->gpu_zones) {
+        return;
+    }
+
+    for (QueryPool& pool : this->query_pools) {
+        glGenQueries(pool.queries.size(), pool.queries.data());
+        pool.zone_count = 0;
+    }
+
+    // Maps GPU timestamps onto the CPU clock. Both clocks are read back to back,
+    // the error is the latency of the query and is well below a zone's length.
+    GLint64 gpu_now {};
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    this->gpu_to_cpu_offset_ns = static_cast<std::int64_t>(now_ns()) - gpu_now;
+}
+
+Profiler::~Profiler() {
+    if (!enabled()) {
+        return;
+    }
+
+    if (this->gpu_zones) {
+        for (QueryPool& pool : this->query_pools) {
+            glDeleteQueries(pool.queries.size(), pool.queries.data());
+        }
+    }
+    profiling_enabled.store(false, std::memory_order_relaxed);
+}
+
+// public
+
+bool Profiler::enabled() {
+    return profiling_enabled.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Profiler::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - profiler_epoch)
+        .count();
+}
+
+void Profiler::record_cpu_zone(
+    const char* name,
+    const std::uint64_t begin_ns,
+    const std::uint64_t end_ns) {
+
+    ThreadZones& zones { local_thread_zones() };
+    const std::size_t head { zones.head.load(std::memory_order_relaxed) };
+    if (head - zones.tail.load(std::memory_order_acquire) == ThreadZones::capacity) {
+        zones.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    zones.zones[head % ThreadZones::capacity] = ProfileEvent {
+        .name = name,
+        .begin_ns = begin_ns,
+        .end_ns = end_ns,
+        .thread_id = zones.thread_id
+    };
+    zones.head.store(head + 1, std::memory_order_release);
+}
+
+std::size_t Profiler::begin_gpu_zone(const char* name) {
+    QueryPool& pool { this->query_pools[this->query_pool_index] };
+    if (!this->gpu_zones || !enabled() || pool.zone_count == max_gpu_zones_per_frame) {
+        return max_gpu_zones_per_frame;
+    }
+
+    const std::size_t zone { pool.zone_count++ };
+    pool.names[zone] = name;
+    glQueryCounter(pool.queries[zone * 2], GL_TIMESTAMP);
+    return zone;
+}
+
+void Profiler::end_gpu_zone(const std::size_t zone) {
+    if (zone == max_gpu_zones_per_frame) {
+        return;
+    }
+
+    const QueryPool& pool { this->query_pools[this->query_pool_index] };
+    glQueryCounter(pool.queries[zone * 2 + 1], GL_TIMESTAMP);
+}
+
+void Profiler::end_frame() {
+    if (!enabled()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock { thread_zones_mutex };
+        for (const std::unique_ptr<ThreadZones>& zones : thread_zones) {
+            const std::size_t tail { zones->tail.load(std::memory_order_relaxed) };
+            const std::size_t head { zones->head.load(std::memory_order_acquire) };
+            for (std::size_t i { tail }; i < head; i++) {
+                this->events.push_back(zones->zones[i % ThreadZones::capacity]);
+            }
+            zones->tail.store(head, std::memory_order_release);
+        }
+    }
+
+    if (!this->gpu_zones) {
+        return;
+    }
+
+    this->query_pool_index = (this->query_pool_index + 1) % query_pool_count;
+    this->resolve_query_pool(this->query_pools[this->query_pool_index]);
+}
+
+void Profiler::write_chrome_trace(const std::filesystem::path& path) const {
+    std::ofstream file { path };
+    if (!file) {
+        log_error(std::format("Failed to open trace file '{}'.", path.c_str()).c_str());
+        return;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << std::format(
+        "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"GPU\"}}}}",
+        gpu_thread_id);
+    {
+        std::lock_guard lock { thread_zones_mutex };
+        for (const std::unique_ptr<ThreadZones>& zones : thread_zones) {
+            file << std::format(
+                ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"CPU {}\"}}}}",
+                zones->thread_id, zones->thread_id);
+
+            const std::size_t dropped { zones->dropped.load(std::memory_order_relaxed) };
+            if (dropped > 0) {
+                log_error(std::format("Profiler dropped {} zones on CPU thread {}.",
+                    dropped, zones->thread_id)
+                        .c_str());
+            }
+        }
+    }
+
+    // Complete events, timestamps are in microseconds.
+    for (const ProfileEvent& event : this->events) {
+        file << std::format(
+            ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            event.name,
+            event.thread_id,
+            event.begin_ns / 1000.0,
+            (event.end_ns - event.begin_ns) / 1000.0);
+    }
+    file << "\n]}\n";
+
+    if (this->dropped_gpu_frames > 0) {
+        log_error(std::format("Profiler dropped GPU zones of {} frames still in flight.",
+            this->dropped_gpu_frames)
+                .c_str());
+    }
+}
+
+// private
+
+void Profiler::resolve_query_pool(QueryPool& pool) {
+    if (pool.zone_count == 0) {
+        return;
+    }
+
+    // Nested zones end out of index order, so every query is checked.
+    for (std::size_t query { 0 }; query < pool.zone_count * 2; query++) {
+        GLint available {};
+        glGetQueryObjectiv(pool.queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            this->dropped_gpu_frames++;
+            pool.zone_count = 0;
+            return;
+        }
+    }
+
+    for (std::size_t zone { 0 }; zone < pool.zone_count; zone++) {
+        GLuint64 begin {};
+        GLuint64 end {};
+        glGetQueryObjectui64v(pool.queries[zone * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(pool.queries[zone * 2 + 1], GL_QUERY_RESULT, &end);
+        this->events.push_back(ProfileEvent {
+            .name = pool.names[zone],
+            .begin_ns = begin + this->gpu_to_cpu_offset_ns,
+            .end_ns = end + this->gpu_to_cpu_offset_ns,
+            .thread_id = gpu_thread_id });
+    }
+    pool.zone_count = 0;
+}
+
+CpuZone::CpuZone(const char* name)
+    : name { name }
+    , begin_ns { Profiler::enabled() ? Profiler::now_ns() : 0 } {
+}
+
+CpuZone::~CpuZone() {
+    if (Profiler::enabled()) {
+        Profiler::record_cpu_zone(this->name, this->begin_ns, Profiler::now_ns());
+    }
+}
+
+GpuZone::GpuZone(Profiler& profiler, const char* name)
+    : profiler { profiler }
+    , zone { profiler.begin_gpu_zone(name) } {
+}
+
+GpuZone::~GpuZone() {
+    this->profiler.end_gpu_zone(this->zone);
+}
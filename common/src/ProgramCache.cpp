@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "ProgramCache.hpp"
+#include "error_handling.hpp"
+#include "hash.hpp"
+
+static constexpr std::uint32_t entry_magic { 0x4c50474c }; // "LGPL"
+
+struct EntryHeader {
+    std::uint32_t magic;
+    std::uint32_t binary_format;
+    std::uint64_t key;
+    std::uint32_t binary_length;
+    // Explicit so no uninitialized padding bytes are written to disk
+    std::uint32_t padding;
+};
+static_assert(std::has_unique_object_representations_v<EntryHeader>);
+
+static std::string_view gl_string(const GLenum name) {
+    const GLubyte* value { glGetString(name) };
+    if (value == nullptr) {
+        return {};
+    }
+    return reinterpret_cast<const char*>(value);
+}
+
+// Constructors
+
+ProgramCache::ProgramCache(std::filesystem::path directory)
+    : directory { std::move(directory) }
+    , context_signature {}
+    , _enabled { false } {
+
+    int format_count {};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count == 0) {
+        return;
+    }
+
+    std::vector<int> formats(static_cast<std::size_t>(format_count));
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    this->context_signature = std::format("{}\n{}\n{}\n",
+        gl_string(GL_VENDOR), gl_string(GL_RENDERER), gl_string(GL_VERSION));
+    for (const int format : formats) {
+        this->context_signature += std::format("{:x}\n", format);
+    }
+
+    std::error_code err {};
+    std::filesystem::create_directories(this->directory, err);
+    if (err) {
+        log_error(std::format("Failed to create program cache directory '{}': {}",
+            this->directory.c_str(), err.message())
+                .c_str());
+        return;
+    }
+
+    this->_enabled = true;
+}
+
+// public
+
+bool ProgramCache::enabled() const {
+    return this->_enabled;
+}
+
+std::uint64_t ProgramCache::make_key(
+    const std::string_view& vertex_code,
+    const std::string_view& fragment_code) const {
+
+    std::uint64_t key { fnv1a(this->context_signature) };
+    key = fnv1a(vertex_code, key);
+    // Keep "ab" + "c" and "a" + "bc" apart.
+    key = fnv1a(std::string_view { "\0", 1 }, key);
+    key = fnv1a(fragment_code, key);
+    return key;
+}
+
+bool ProgramCache::load(const unsigned int program, const std::uint64_t key) const {
+    if (!this->_enabled) {
+        return false;
+    }
+
+    const std::filesystem::path path { this->entry_path(key) };
+    std::ifstream file { path, std::ios::binary };
+    if (!file) {
+        return false;
+    }
+
+    std::error_code err {};
+    EntryHeader header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != entry_magic || header.key != key) {
+        std::filesystem::remove(path, err);
+        return false;
+    }
+
+    // The length comes from disk, check it before allocating for it.
+    const std::uintmax_t file_size { std::filesystem::file_size(path, err) };
+    if (err || file_size < sizeof(header) || header.binary_length != file_size - sizeof(header)) {
+        std::filesystem::remove(path, err);
+        return false;
+    }
+
+    std::vector<char> binary(header.binary_length);
+    file.read(binary.data(), binary.size());
+    if (!file) {
+        std::filesystem::remove(path, err);
+        return false;
+    }
+
+    glProgramBinary(program, header.binary_format, binary.data(), binary.size());
+
+    int success {};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        log_error(std::format("Driver rejected cached program '{}', building from source.",
+            path.c_str())
+                .c_str());
+        std::filesystem::remove(path, err);
+        return false;
+    }
+
+    return true;
+}
+
+void ProgramCache::store(const unsigned int program, const std::uint64_t key) const {
+    if (!this->_enabled) {
+        return;
+    }
+
+    int binary_length {};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<std::size_t>(binary_length));
+    GLenum binary_format {};
+    glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
+
+    const EntryHeader header {
+        .magic = entry_magic,
+        .binary_format = binary_format,
+        .key = key,
+        .binary_length = static_cast<std::uint32_t>(binary_length),
+        .padding = 0
+    };
+
+    // Write to a temporary file first so a crash never leaves a truncated entry.
+    std::error_code err {};
+    const std::filesystem::path path { this->entry_path(key) };
+    std::filesystem::path tmp_path { path };
+    tmp_path += ".tmp";
+
+    std::ofstream file { tmp_path, std::ios::binary | std::ios::trunc };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
+    file.close();
+    if (!file) {
+        log_error(std::format("Failed to write program cache entry '{}'.", tmp_path.c_str()).c_str());
+        std::filesystem::remove(tmp_path, err);
+        return;
+    }
+
+    std::filesystem::rename(tmp_path, path, err);
+    if (err) {
+        log_error(std::format("Failed to write program cache entry '{}': {}",
+            path.c_str(), err.message())
+                .c_str());
+        std::filesystem::remove(tmp_path, err);
+    }
+}
+
+// private
+
+std::filesystem::path ProgramCache::entry_path(const std::uint64_t key) const {
+    return this->directory / std::format("{:016x}.bin", key);
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <limits>
+
+#include "JobSystem.hpp"
+#include "SceneGraph.hpp"
+
+// Nodes per chunk, the unit of dirty tracking and of the jobs of update()
+static constexpr std::size_t nodes_per_chunk { 1024 };
+
+// public
+
+SceneGraph::Node SceneGraph::add_root(
+    const glm::vec3& position,
+    const glm::quat& rotation,
+    const glm::vec3& scale) {
+
+    return this->add_node(0, 0, position, rotation, scale);
+}
+
+SceneGraph::Node SceneGraph::add_child(
+    const Node parent,
+    const glm::vec3& position,
+    const glm::quat& rotation,
+    const glm::vec3& scale) {
+
+    return this->add_node(parent.level + 1, parent.index, position, rotation, scale);
+}
+
+void SceneGraph::set_position(const Node node, const glm::vec3& position) {
+    Level& level { this->levels[node.level] };
+    level.local.set_position(node.index, position);
+    this->mark_dirty(node);
+}
+
+void SceneGraph::set_rotation(const Node node, const glm::quat& rotation) {
+    Level& level { this->levels[node.level] };
+    level.local.set_rotation(node.index, rotation);
+    this->mark_dirty(node);
+}
+
+void SceneGraph::set_scale(const Node node, const glm::vec3& scale) {
+    Level& level { this->levels[node.level] };
+    level.local.set_scale(node.index, scale);
+    this->mark_dirty(node);
+}
+
+void SceneGraph::update() {
+    this->update_serial++;
+
+    // A level reads the world matrices of the one above, so levels run in order
+    // and the chunks of a level in parallel.
+    for (std::size_t level { 0 }; level < this->levels.size(); level++) {
+        Level& nodes { this->levels[level] };
+        const Range parents_changed {
+            level > 0 ? this->levels[level - 1].changed : Range { 0, 0 }
+        };
+        const bool any_parent_changed { parents_changed.begin < parents_changed.end };
+        nodes.changed = Range { 0, 0 };
+        if (nodes.dirty_chunk_count == 0 && !any_parent_changed) {
+            continue;
+        }
+
+        this->update_chunks.clear();
+        for (std::size_t chunk { 0 }; chunk < nodes.dirty_chunks.size(); chunk++) {
+            const Range& parents { nodes.chunk_parents[chunk] };
+            const bool below_change {
+                any_parent_changed
+                && parents.begin < parents_changed.end
+                && parents.end > parents_changed.begin
+            };
+            if (nodes.dirty_chunks[chunk] != 0 || below_change) {
+                this->update_chunks.push_back(static_cast<std::uint32_t>(chunk));
+            }
+        }
+        nodes.dirty_chunk_count = 0;
+
+        this->chunk_changes.resize(this->update_chunks.size());
+        job_system().parallel_for(this->update_chunks.size(), 1,
+            [this, level](const std::size_t begin, const std::size_t end) {
+                for (std::size_t i { begin }; i < end; i++) {
+                    this->chunk_changes[i] = this->update_chunk(level, this->update_chunks[i]);
+                }
+            });
+
+        Range changed { std::numeric_limits<std::uint32_t>::max(), 0 };
+        for (const Range& chunk_changed : this->chunk_changes) {
+            if (chunk_changed.begin < chunk_changed.end) {
+                changed.begin = std::min(changed.begin, chunk_changed.begin);
+                changed.end = std::max(changed.end, chunk_changed.end);
+            }
+        }
+        if (changed.begin < changed.end) {
+            nodes.changed = changed;
+        }
+    }
+}
+
+const glm::mat4& SceneGraph::world_matrix(const Node node) const {
+    return this->levels[node.level].world_matrices[node.index];
+}
+
+std::span<const glm::mat4> SceneGraph::world_matrices(const std::size_t level) const {
+    return this->levels[level].world_matrices;
+}
+
+std::size_t SceneGraph::level_count() const {
+    return this->levels.size();
+}
+
+std::size_t SceneGraph::node_count(const std::size_t level) const {
+    return this->levels[level].parents.size();
+}
+
+// private
+
+SceneGraph::Node SceneGraph::add_node(
+    const std::size_t level,
+    const std::uint32_t parent,
+    const glm::vec3& position,
+    const glm::quat& rotation,
+    const glm::vec3& scale) {
+
+    if (level == this->levels.size()) {
+        this->levels.emplace_back();
+    }
+
+    Level& nodes { this->levels[level] };
+    const std::uint32_t index { nodes.local.add(position, rotation, scale) };
+    nodes.parents.push_back(parent);
+    nodes.local_matrices.emplace_back(1.0f);
+    nodes.world_matrices.emplace_back(1.0f);
+    nodes.local_dirty.push_back(0);
+    nodes.world_changed.push_back(0);
+
+    if (index % nodes_per_chunk == 0) {
+        nodes.dirty_chunks.push_back(0);
+        nodes.chunk_parents.push_back(Range { parent, parent + 1 });
+    }
+    Range& chunk_parents { nodes.chunk_parents.back() };
+    chunk_parents.begin = std::min(chunk_parents.begin, parent);
+    chunk_parents.end = std::max(chunk_parents.end, parent + 1);
+
+    const Node node { .level = static_cast<std::uint32_t>(level), .index = index };
+    this->mark_dirty(node);
+    return node;
+}
+
+void SceneGraph::mark_dirty(const Node node) {
+    Level& level { this->levels[node.level] };
+    level.local_dirty[node.index] = 1;
+
+    std::uint8_t& chunk_dirty { level.dirty_chunks[node.index / nodes_per_chunk] };
+    if (chunk_dirty == 0) {
+        chunk_dirty = 1;
+        level.dirty_chunk_count++;
+    }
+}
+
+SceneGraph::Range SceneGraph::update_chunk(const std::size_t level, const std::size_t chunk) {
+    Level& nodes { this->levels[level] };
+    const std::size_t begin { chunk * nodes_per_chunk };
+    const std::size_t end { std::min(begin + nodes_per_chunk, nodes.parents.size()) };
+
+    // Runs of dirty nodes are rebuilt in batches.
+    if (nodes.dirty_chunks[chunk] != 0) {
+        std::size_t run_begin { begin };
+        while (run_begin < end) {
+            if (nodes.local_dirty[run_begin] == 0) {
+                run_begin++;
+                continue;
+            }
+            std::size_t run_end { run_begin + 1 };
+            while (run_end < end && nodes.local_dirty[run_end] != 0) {
+                run_end++;
+            }
+            nodes.local.write_model_matrices(static_cast<TransformStore::Index>(run_begin),
+                run_end - run_begin, &nodes.local_matrices[run_begin]);
+            run_begin = run_end;
+        }
+        nodes.dirty_chunks[chunk] = 0;
+    }
+
+    Range changed { static_cast<std::uint32_t>(end), 0 };
+    const Level* parents { level > 0 ? &this->levels[level - 1] : nullptr };
+    for (std::size_t i { begin }; i < end; i++) {
+        const bool parent_changed {
+            parents != nullptr && parents->world_changed[nodes.parents[i]] == this->update_serial
+        };
+        if (nodes.local_dirty[i] == 0 && !parent_changed) {
+            continue;
+        }
+
+        nodes.world_matrices[i] = parents != nullptr
+            ? parents->world_matrices[nodes.parents[i]] * nodes.local_matrices[i]
+            : nodes.local_matrices[i];
+        nodes.world_changed[i] = this->update_serial;
+        nodes.local_dirty[i] = 0;
+        changed.begin = std::min(changed.begin, static_cast<std::uint32_t>(i));
+        changed.end = static_cast<std::uint32_t>(i + 1);
+    }
+    return changed;
+}
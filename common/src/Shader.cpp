@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "glad/glad.h"
+
+#include "GlState.hpp"
+#include "ProgramCache.hpp"
+#include "Shader.hpp"
+#include "error_handling.hpp"
+#include "hash.hpp"
+#include "parallel_shader_compile.hpp"
+#include "quit.hpp"
+#include "shader_preprocessor.hpp"
+
+struct UniformBlockBinding {
+    std::string block_name;
+    unsigned int binding;
+};
+
+// Set from the thread owning the GL context before the programs are built.
+static std::vector<UniformBlockBinding> uniform_block_bindings;
+
+// Constructors
+
+Shader::Shader(
+    const char* vertex_path,
+    const char* fragment_path,
+    const ProgramCache* program_cache)
+    : _id { 0 }
+    , program_cache { program_cache } {
+
+    this->start_from_sources({
+        StageSource { .type = GL_VERTEX_SHADER, .name = "vertex", .path = vertex_path },
+        StageSource { .type = GL_FRAGMENT_SHADER, .name = "fragment", .path = fragment_path }
+    }, {});
+    this->finish_initial_build();
+}
+
+Shader::Shader(const char* compute_path, const ProgramCache* program_cache)
+    : _id { 0 }
+    , program_cache { program_cache } {
+
+    this->start_from_sources({
+        StageSource { .type = GL_COMPUTE_SHADER, .name = "compute", .path = compute_path }
+    }, {});
+    this->finish_initial_build();
+}
+
+Shader::Shader(
+    const char* vertex_path,
+    const char* fragment_path,
+    const ProgramCache* program_cache,
+    Deferred,
+    const std::span<const std::string_view> defines)
+    : _id { 0 }
+    , program_cache { program_cache } {
+
+    this->start_from_sources({
+        StageSource { .type = GL_VERTEX_SHADER, .name = "vertex", .path = vertex_path },
+        StageSource { .type = GL_FRAGMENT_SHADER, .name = "fragment", .path = fragment_path }
+    }, defines);
+}
+
+Shader::Shader(
+    const char* compute_path,
+    const ProgramCache* program_cache,
+    Deferred,
+    const std::span<const std::string_view> defines)
+    : _id { 0 }
+    , program_cache { program_cache } {
+
+    this->start_from_sources({
+        StageSource { .type = GL_COMPUTE_SHADER, .name = "compute", .path = compute_path }
+    }, defines);
+}
+
+void Shader::finish_builds(const std::span<Shader* const> shaders) {
+    std::vector<Shader*> building { shaders.begin(), shaders.end() };
+    while (!building.empty()) {
+        const auto finished { std::ranges::remove_if(building, [](Shader* shader) {
+            if (shader->pending && !shader->build_complete(*shader->pending)) {
+                return false;
+            }
+            shader->finish_initial_build();
+            return true;
+        }) };
+        building.erase(finished.begin(), finished.end());
+
+        if (!building.empty()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Shader::set_uniform_block_binding(
+    const std::string_view& block_name,
+    const unsigned int binding) {
+
+    const auto existing { std::ranges::find(uniform_block_bindings, block_name,
+        &UniformBlockBinding::block_name) };
+    if (existing != uniform_block_bindings.end()) {
+        existing->binding = binding;
+        return;
+    }
+    uniform_block_bindings.push_back(UniformBlockBinding {
+        .block_name = std::string { block_name },
+        .binding = binding
+    });
+}
+
+// public
+
+unsigned int Shader::id() const {
+    return this->_id;
+}
+
+std::vector<std::filesystem::path> Shader::source_paths() const {
+    return this->dependencies;
+}
+
+void Shader::reload() {
+    if (this->pending) {
+        for (const unsigned int shader : this->pending->shaders) {
+            glDeleteShader(shader);
+        }
+        gl_state().delete_program(this->pending->program);
+        this->pending.reset();
+    }
+
+    std::vector<Stage> stages;
+    if (this->read_stages(stages)) {
+        this->pending = this->start_build(stages);
+    }
+}
+
+Shader::ReloadStatus Shader::poll_reload() {
+    if (!this->pending) {
+        return ReloadStatus::IDLE;
+    }
+    if (!this->build_complete(*this->pending)) {
+        return ReloadStatus::PENDING;
+    }
+
+    const unsigned int program { this->finish_build(*this->pending) };
+    this->pending.reset();
+    if (program == 0) {
+        return ReloadStatus::FAILED;
+    }
+
+    gl_state().delete_program(this->_id);
+    this->_id = program;
+    this->bind_uniform_blocks();
+    this->reflect_uniforms();
+    return ReloadStatus::RELOADED;
+}
+
+void Shader::use() const {
+    gl_state().use_program(this->_id);
+}
+
+void Shader::set_bool(const std::string_view& name, const bool value) const {
+    glProgramUniform1i(this->_id, this->find_uniform_location(name), static_cast<int>(value));
+}
+
+void Shader::set_int(const std::string_view& name, const int value) const {
+    glProgramUniform1i(this->_id, this->require_uniform_location(name), value);
+}
+
+void Shader::set_float(const std::string_view& name, const float value) const {
+    glProgramUniform1f(this->_id, this->require_uniform_location(name), value);
+}
+
+void Shader::set_vec3(const std::string_view &name, const glm::vec3& value) const {
+    glProgramUniform3fv(this->_id, this->require_uniform_location(name), 1, glm::value_ptr(value));
+}
+
+void Shader::set_mat4(const std::string_view& name, const glm::mat4& value) const {
+    glProgramUniformMatrix4fv(this->_id, this->require_uniform_location(name), 1, GL_FALSE,
+        glm::value_ptr(value));
+}
+
+void Shader::set_bool(const Shader::Uniform<bool> uniform, const bool value) const {
+    glProgramUniform1i(this->_id, this->handle_locations[uniform.handle], static_cast<int>(value));
+}
+
+void Shader::set_int(const Shader::Uniform<int> uniform, const int value) const {
+    glProgramUniform1i(this->_id, this->handle_locations[uniform.handle], value);
+}
+
+void Shader::set_float(const Shader::Uniform<float> uniform, const float value) const {
+    glProgramUniform1f(this->_id, this->handle_locations[uniform.handle], value);
+}
+
+void Shader::set_vec3(const Shader::Uniform<glm::vec3> uniform, const glm::vec3& value) const {
+    glProgramUniform3fv(this->_id, this->handle_locations[uniform.handle], 1, glm::value_ptr(value));
+}
+
+void Shader::set_vec4(
+    const Shader::Uniform<glm::vec4> uniform,
+    const std::span<const glm::vec4> values) const {
+
+    glProgramUniform4fv(this->_id, this->handle_locations[uniform.handle], static_cast<int>(values.size()),
+        glm::value_ptr(values.front()));
+}
+
+void Shader::set_mat4(const Shader::Uniform<glm::mat4> uniform, const glm::mat4& value) const {
+    glProgramUniformMatrix4fv(this->_id, this->handle_locations[uniform.handle], 1, GL_FALSE, glm::value_ptr(value));
+}
+
+// private
+
+void Shader::start_from_sources(
+    std::vector<StageSource> sources,
+    const std::span<const std::string_view> defines) {
+
+    this->sources = std::move(sources);
+    this->defines.assign(defines.begin(), defines.end());
+
+    std::vector<Stage> stages;
+    if (!this->read_stages(stages)) {
+        quit(1);
+    }
+    this->pending = this->start_build(stages);
+}
+
+void Shader::finish_initial_build() {
+    if (!this->pending) {
+        return;
+    }
+
+    this->_id = this->finish_build(*this->pending);
+    this->pending.reset();
+    if (this->_id == 0) {
+        quit(1);
+    }
+    this->bind_uniform_blocks();
+    this->reflect_uniforms();
+
+    // Handles taken before the build finished are checked now.
+    for (std::size_t handle { 0 }; handle < this->handle_names.size(); handle++) {
+        if (this->handle_locations[handle] == -1) {
+            log_error(std::format("Could not find uniform '{}'", this->handle_names[handle]).c_str());
+            quit(1);
+        }
+    }
+}
+
+bool Shader::read_stages(std::vector<Stage>& stages) {
+    const std::vector<std::string_view> defines { this->defines.begin(), this->defines.end() };
+    std::vector<std::filesystem::path> dependencies;
+
+    stages.clear();
+    for (const StageSource& source : this->sources) {
+        PreprocessedShader preprocessed;
+        if (!preprocess_shader(source.path, defines, preprocessed)) {
+            return false;
+        }
+        for (std::filesystem::path& file : preprocessed.files) {
+            if (std::ranges::find(dependencies, file) == dependencies.end()) {
+                dependencies.push_back(std::move(file));
+            }
+        }
+        stages.push_back(Stage {
+            .type = source.type,
+            .name = source.name,
+            .code = std::move(preprocessed.code)
+        });
+    }
+
+    this->dependencies = std::move(dependencies);
+    return true;
+}
+
+Shader::PendingProgram Shader::start_build(const std::span<const Stage> stages) const {
+    PendingProgram pending { .program = glCreateProgram(), .shaders = {}, .cache_key = 0 };
+    if (pending.program == 0) {
+        log_error("Failed to create program.");
+        quit(1);
+    }
+
+    const bool use_cache { this->program_cache != nullptr && this->program_cache->enabled() };
+    if (use_cache) {
+        // A compute program keys on its only stage and an empty second one.
+        pending.cache_key = this->program_cache->make_key(stages[0].code,
+            stages.size() > 1 ? std::string_view { stages[1].code } : std::string_view {});
+        if (this->program_cache->load(pending.program, pending.cache_key)) {
+            return pending;
+        }
+    }
+
+    for (const Stage& stage : stages) {
+        const unsigned int shader { glCreateShader(stage.type) };
+        if (shader == 0) {
+            log_error(std::format("Failed to create {} shader.", stage.name).c_str());
+            quit(1);
+        }
+
+        const char* code_c_str { stage.code.c_str() };
+        glShaderSource(shader, 1, &code_c_str, nullptr);
+        glCompileShader(shader);
+
+        glAttachShader(pending.program, shader);
+        pending.shaders.push_back(shader);
+    }
+
+    if (use_cache) {
+        glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Compile and link status are only queried when finishing, so the driver may
+    // still be working when this returns.
+    glLinkProgram(pending.program);
+    return pending;
+}
+
+bool Shader::build_complete(const PendingProgram& pending) const {
+    // Loaded from the program cache
+    if (pending.shaders.empty() || !parallel_shader_compile_supported()) {
+        return true;
+    }
+
+    int complete {};
+    glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+unsigned int Shader::finish_build(PendingProgram& pending) const {
+    // Loaded from the program cache
+    if (pending.shaders.empty()) {
+        return pending.program;
+    }
+
+    bool success { true };
+    for (const unsigned int shader : pending.shaders) {
+        success = log_shader_compile_error(shader) && success;
+    }
+    success = success && log_shader_program_link_error(pending.program);
+
+    // Delete linked shaders
+    for (const unsigned int shader : pending.shaders) {
+        glDetachShader(pending.program, shader);
+        glDeleteShader(shader);
+    }
+    pending.shaders.clear();
+
+    if (!success) {
+        gl_state().delete_program(pending.program);
+        return 0;
+    }
+
+    if (this->program_cache != nullptr && this->program_cache->enabled()) {
+        this->program_cache->store(pending.program, pending.cache_key);
+    }
+    return pending.program;
+}
+
+int Shader::add_uniform_handle(const std::string_view& name) {
+    this->handle_names.emplace_back(name);
+    // Resolved once a deferred build finishes
+    this->handle_locations.push_back(
+        this->_id == 0 ? -1 : this->require_uniform_location(name));
+    return static_cast<int>(this->handle_locations.size() - 1);
+}
+
+void Shader::bind_uniform_blocks() const {
+    // Bindings are program state that binaries from the program cache do not
+    // keep, so they are set after every build.
+    for (const UniformBlockBinding& block : uniform_block_bindings) {
+        const unsigned int index { glGetUniformBlockIndex(this->_id, block.block_name.c_str()) };
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(this->_id, index, block.binding);
+        }
+    }
+}
+
+void Shader::reflect_uniforms() {
+    int uniform_count {};
+    glGetProgramiv(this->_id, GL_ACTIVE_UNIFORMS, &uniform_count);
+    int max_name_length {};
+    glGetProgramiv(this->_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    // Keep the load factor at or below one half so probes stay short.
+    const std::size_t table_size {
+        std::bit_ceil(static_cast<std::size_t>(uniform_count) * 2 + 1)
+    };
+    this->uniforms.assign(table_size, UniformEntry {});
+
+    std::string name_buffer(static_cast<std::size_t>(max_name_length), '\0');
+    for (int i { 0 }; i < uniform_count; i++) {
+        int name_length {};
+        int size {};
+        unsigned int type {};
+        glGetActiveUniform(this->_id, i, max_name_length, &name_length, &size, &type,
+            name_buffer.data());
+
+        std::string name { name_buffer.data(), static_cast<std::size_t>(name_length) };
+        const int location { glGetUniformLocation(this->_id, name.c_str()) };
+        // Uniforms inside blocks have no location.
+        if (location == -1) {
+            continue;
+        }
+
+        // Arrays are reported as "name[0]", look them up by the plain name.
+        if (name.ends_with("[0]")) {
+            name.resize(name.size() - 3);
+        }
+
+        const std::uint64_t hash { fnv1a(name) };
+        std::size_t slot { hash & (table_size - 1) };
+        while (this->uniforms[slot].location != -1) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        this->uniforms[slot] = UniformEntry {
+            .hash = hash,
+            .name = std::move(name),
+            .location = location
+        };
+    }
+
+    // A uniform removed by a reload keeps a handle with location -1, which GL
+    // ignores.
+    for (std::size_t handle { 0 }; handle < this->handle_names.size(); handle++) {
+        this->handle_locations[handle] = this->find_uniform_location(this->handle_names[handle]);
+    }
+}
+
+int Shader::find_uniform_location(const std::string_view& name) const {
+    const std::size_t mask { this->uniforms.size() - 1 };
+    const std::uint64_t hash { fnv1a(name) };
+    for (std::size_t slot { hash & mask }; this->uniforms[slot].location != -1;
+        slot = (slot + 1) & mask) {
+        const UniformEntry& entry { this->uniforms[slot] };
+        if (entry.hash == hash && entry.name == name) {
+            return entry.location;
+        }
+    }
+    return -1;
+}
+
+int Shader::require_uniform_location(const std::string_view& name) const {
+    const int location { this->find_uniform_location(name) };
+    if (location == -1) {
+        log_error(std::format("Could not find uniform '{}'", name).data());
+        quit(1);
+    }
+    return location;
+}
@@ -0,0 +1,70 @@
+#include <array>
+
+#include "ShaderVariants.hpp"
+#include "hash.hpp"
+#include "quit.hpp"
+#include "shader_preprocessor.hpp"
+
+// Hash of the preprocessed stages, quits if one cannot be preprocessed.
+static std::uint64_t variant_key(
+    const std::span<const char* const> paths,
+    const std::span<const std::string_view> defines) {
+
+    std::uint64_t key { fnv1a_offset_basis };
+    for (const char* path : paths) {
+        PreprocessedShader preprocessed;
+        if (!preprocess_shader(path, defines, preprocessed)) {
+            quit(1);
+        }
+        key = fnv1a(preprocessed.code, key);
+        // Keep "ab" + "c" and "a" + "bc" apart.
+        key = fnv1a(std::string_view { "\0", 1 }, key);
+    }
+    return key;
+}
+
+// Constructors
+
+ShaderVariants::ShaderVariants(const ProgramCache* program_cache)
+    : program_cache { program_cache } {
+}
+
+// public
+
+Shader& ShaderVariants::get(
+    const char* vertex_path,
+    const char* fragment_path,
+    const std::span<const std::string_view> defines) {
+
+    const std::array paths { vertex_path, fragment_path };
+    std::unique_ptr<Shader>& shader { this->shaders[variant_key(paths, defines)] };
+    if (shader == nullptr) {
+        shader = std::make_unique<Shader>(vertex_path, fragment_path, this->program_cache,
+            Shader::deferred, defines);
+        this->building.push_back(shader.get());
+    }
+    return *shader;
+}
+
+Shader& ShaderVariants::get(
+    const char* compute_path,
+    const std::span<const std::string_view> defines) {
+
+    const std::array paths { compute_path };
+    std::unique_ptr<Shader>& shader { this->shaders[variant_key(paths, defines)] };
+    if (shader == nullptr) {
+        shader = std::make_unique<Shader>(compute_path, this->program_cache, Shader::deferred,
+            defines);
+        this->building.push_back(shader.get());
+    }
+    return *shader;
+}
+
+void ShaderVariants::finish_builds() {
+    Shader::finish_builds(this->building);
+    this->building.clear();
+}
+
+std::size_t ShaderVariants::size() const {
+    return this->shaders.size();
+}
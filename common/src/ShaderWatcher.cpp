@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <print>
+#include <ranges>
+#include <string>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "ShaderWatcher.hpp"
+#include "error_handling.hpp"
+
+// Writes by editors that save in place, save by renaming a temporary file or by
+// recreating the file.
+static constexpr std::uint32_t watch_mask { IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE };
+
+// "shader.vert, shader.frag" for log messages
+static std::string source_names(const std::vector<std::filesystem::path>& paths) {
+    std::string names;
+    for (const std::filesystem::path& path : paths) {
+        if (!names.empty()) {
+            names += ", ";
+        }
+        names += path.filename().string();
+    }
+    return names;
+}
+
+// Constructors
+
+ShaderWatcher::ShaderWatcher()
+    : fd { inotify_init1(IN_NONBLOCK | IN_CLOEXEC) } {
+
+    if (this->fd == -1) {
+        log_error(std::format("inotify_init1 failed, shaders will not be reloaded: {}",
+            std::strerror(errno)).c_str());
+    }
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    if (this->fd != -1) {
+        close(this->fd);
+    }
+}
+
+// public
+
+void ShaderWatcher::watch(Shader& shader) {
+    this->shaders.push_back(WatchedShader {
+        .shader = &shader,
+        .paths = this->watch_sources(shader)
+    });
+}
+
+void ShaderWatcher::poll() {
+    if (this->fd == -1) {
+        return;
+    }
+
+    // Several events for the same save are merged, each shader reloads once.
+    std::vector<Shader*> changed;
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length { read(this->fd, buffer, sizeof(buffer)) };
+        if (length <= 0) {
+            break;
+        }
+
+        for (ssize_t offset { 0 }; offset < length;) {
+            const auto* event { reinterpret_cast<const inotify_event*>(buffer + offset) };
+            offset += sizeof(inotify_event) + event->len;
+
+            const auto directory { this->directories.find(event->wd) };
+            if (event->len == 0 || directory == this->directories.end()) {
+                continue;
+            }
+
+            const std::filesystem::path path { directory->second / event->name };
+            for (const WatchedShader& watched : this->shaders) {
+                if (std::ranges::find(watched.paths, path) != watched.paths.end()
+                    && std::ranges::find(changed, watched.shader) == changed.end()) {
+                    changed.push_back(watched.shader);
+                }
+            }
+        }
+    }
+
+    // Finish reloads started on earlier frames first, so a reload started now gets
+    // a frame to compile. A finished reload may include other files than before,
+    // a failed one too, so the watched paths are taken from the shader again.
+    for (WatchedShader& watched : this->shaders) {
+        switch (watched.shader->poll_reload()) {
+        case Shader::ReloadStatus::RELOADED:
+            watched.paths = this->watch_sources(*watched.shader);
+            std::println("Reloaded shader {}", source_names(watched.paths));
+            break;
+        case Shader::ReloadStatus::FAILED:
+            watched.paths = this->watch_sources(*watched.shader);
+            log_error(std::format("Reloading shader {} failed, keeping the previous program.",
+                source_names(watched.paths)).c_str());
+            break;
+        case Shader::ReloadStatus::IDLE:
+        case Shader::ReloadStatus::PENDING:
+            break;
+        }
+    }
+
+    for (Shader* shader : changed) {
+        shader->reload();
+    }
+}
+
+// private
+
+std::vector<std::filesystem::path> ShaderWatcher::watch_sources(const Shader& shader) {
+    std::vector<std::filesystem::path> paths;
+    for (const std::filesystem::path& path : shader.source_paths()) {
+        paths.push_back(std::filesystem::weakly_canonical(path));
+        if (this->fd == -1) {
+            continue;
+        }
+
+        const std::filesystem::path directory { paths.back().parent_path() };
+        const auto watched_directories { this->directories | std::views::values };
+        if (std::ranges::find(watched_directories, directory) != watched_directories.end()) {
+            continue;
+        }
+
+        const int wd { inotify_add_watch(this->fd, directory.c_str(), watch_mask) };
+        if (wd == -1) {
+            log_error(std::format("Failed to watch '{}': {}", directory.c_str(),
+                std::strerror(errno)).c_str());
+            continue;
+        }
+        this->directories.emplace(wd, directory);
+    }
+    return paths;
+}
@@ -0,0 +1,561 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOFTWARE_RASTERIZER_X86
+#endif
+
+#include "stb_image.h"
+
+#include "JobSystem.hpp"
+#include "SoftwareRasterizer.hpp"
+
+static constexpr int block_size { SoftwareRasterizer::depth_block_size };
+
+static int round_up(const int value, const int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static std::uint32_t pack_color(const glm::vec3& color) {
+    const glm::vec3 bytes { glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f };
+    return static_cast<std::uint32_t>(bytes.r)
+        | static_cast<std::uint32_t>(bytes.g) << 8
+        | static_cast<std::uint32_t>(bytes.b) << 16
+        | 0xFFu << 24;
+}
+
+static float evaluate(const glm::vec3& plane, const float x, const float y) {
+    return plane.x * x + plane.y * y + plane.z;
+}
+
+// Largest value of the plane over the pixel centers of a block
+static float block_max(const glm::vec3& plane, const float min_x, const float min_y) {
+    const float max_x { min_x + block_size - 1 };
+    const float max_y { min_y + block_size - 1 };
+    return plane.z
+        + plane.x * (plane.x > 0.0f ? max_x : min_x)
+        + plane.y * (plane.y > 0.0f ? max_y : min_y);
+}
+
+static std::uint32_t read_index(const Mesh& mesh, const std::size_t i) {
+    switch (mesh.index_type) {
+    case GL_UNSIGNED_BYTE:
+        return static_cast<std::uint32_t>(mesh.indices[i]);
+    case GL_UNSIGNED_SHORT: {
+        std::uint16_t index {};
+        std::memcpy(&index, mesh.indices.data() + i * sizeof(index), sizeof(index));
+        return index;
+    }
+    default: {
+        std::uint32_t index {};
+        std::memcpy(&index, mesh.indices.data() + i * sizeof(index), sizeof(index));
+        return index;
+    }
+    }
+}
+
+static glm::vec3 texel(const SoftwareRasterizer::Texture& texture, int x, int y) {
+    // GL_REPEAT
+    x = (x % texture.width + texture.width) % texture.width;
+    y = (y % texture.height + texture.height) % texture.height;
+    const unsigned char* rgb { &texture.rgb[(static_cast<std::size_t>(y) * texture.width + x) * 3] };
+    return glm::vec3 { rgb[0], rgb[1], rgb[2] } / 255.0f;
+}
+
+static glm::vec3 sample(const SoftwareRasterizer::Texture& texture, const float u, const float v) {
+    const float x { u * texture.width - 0.5f };
+    const float y { v * texture.height - 0.5f };
+    const float floor_x { std::floor(x) };
+    const float floor_y { std::floor(y) };
+    const int x0 { static_cast<int>(floor_x) };
+    const int y0 { static_cast<int>(floor_y) };
+
+    const glm::vec3 bottom {
+        glm::mix(texel(texture, x0, y0), texel(texture, x0 + 1, y0), x - floor_x)
+    };
+    const glm::vec3 top {
+        glm::mix(texel(texture, x0, y0 + 1), texel(texture, x0 + 1, y0 + 1), x - floor_x)
+    };
+    return glm::mix(bottom, top, y - floor_y);
+}
+
+// Coverage and depth test of a depth block, passing depths are written. Returns
+// eight bits of passing pixels per row, the first row in the lowest byte.
+static std::uint64_t cover_block(
+    const glm::vec3& edge_a,
+    const glm::vec3& edge_b,
+    const glm::vec3& edge_c,
+    const glm::vec3& depth_plane,
+    float* depth,
+    const int stride,
+    const int x,
+    const int y) {
+
+    std::uint64_t masks { 0 };
+    for (int row { 0 }; row < block_size; row++) {
+        const float center_y { y + row + 0.5f };
+        float* row_depth { depth + static_cast<std::size_t>(y + row) * stride + x };
+        unsigned int mask { 0 };
+        for (int column { 0 }; column < block_size; column++) {
+            const float center_x { x + column + 0.5f };
+            const glm::vec3 barycentric { edge_a * center_x + edge_b * center_y + edge_c };
+            const float z { evaluate(depth_plane, center_x, center_y) };
+            if (barycentric.x >= 0.0f && barycentric.y >= 0.0f && barycentric.z >= 0.0f
+                && z < row_depth[column]) {
+                row_depth[column] = z;
+                mask |= 1u << column;
+            }
+        }
+        masks |= static_cast<std::uint64_t>(mask) << (row * block_size);
+    }
+    return masks;
+}
+
+#ifdef SOFTWARE_RASTERIZER_X86
+// Same as cover_block with the eight pixels of a row in one AVX2 register.
+__attribute__((target("avx2")))
+static std::uint64_t cover_block_avx2(
+    const glm::vec3& edge_a,
+    const glm::vec3& edge_b,
+    const glm::vec3& edge_c,
+    const glm::vec3& depth_plane,
+    float* depth,
+    const int stride,
+    const int x,
+    const int y) {
+
+    const __m256 centers_x {
+        _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)),
+            _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f))
+    };
+    const __m256 zero { _mm256_setzero_ps() };
+
+    // Terms along x stay the same for every row.
+    const __m256 edge0_x { _mm256_mul_ps(_mm256_set1_ps(edge_a.x), centers_x) };
+    const __m256 edge1_x { _mm256_mul_ps(_mm256_set1_ps(edge_a.y), centers_x) };
+    const __m256 edge2_x { _mm256_mul_ps(_mm256_set1_ps(edge_a.z), centers_x) };
+    const __m256 depth_x { _mm256_mul_ps(_mm256_set1_ps(depth_plane.x), centers_x) };
+
+    std::uint64_t masks { 0 };
+    for (int row { 0 }; row < block_size; row++) {
+        const float center_y { y + row + 0.5f };
+        const __m256 edge0 {
+            _mm256_add_ps(edge0_x, _mm256_set1_ps(edge_b.x * center_y + edge_c.x))
+        };
+        const __m256 edge1 {
+            _mm256_add_ps(edge1_x, _mm256_set1_ps(edge_b.y * center_y + edge_c.y))
+        };
+        const __m256 edge2 {
+            _mm256_add_ps(edge2_x, _mm256_set1_ps(edge_b.z * center_y + edge_c.z))
+        };
+        const __m256 inside {
+            _mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ),
+                _mm256_and_ps(_mm256_cmp_ps(edge1, zero, _CMP_GE_OQ),
+                    _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ)))
+        };
+        if (_mm256_movemask_ps(inside) == 0) {
+            continue;
+        }
+
+        float* row_depth { depth + static_cast<std::size_t>(y + row) * stride + x };
+        const __m256 z {
+            _mm256_add_ps(depth_x,
+                _mm256_set1_ps(depth_plane.y * center_y + depth_plane.z))
+        };
+        const __m256 old_z { _mm256_loadu_ps(row_depth) };
+        const __m256 pass { _mm256_and_ps(inside, _mm256_cmp_ps(z, old_z, _CMP_LT_OQ)) };
+        const int mask { _mm256_movemask_ps(pass) };
+        if (mask != 0) {
+            _mm256_storeu_ps(row_depth, _mm256_blendv_ps(old_z, z, pass));
+            masks |= static_cast<std::uint64_t>(mask) << (row * block_size);
+        }
+    }
+    return masks;
+}
+#endif
+
+// Constructors
+
+SoftwareRasterizer::SoftwareRasterizer(const int width, const int height)
+    : _width { width }
+    , _height { height }
+    , stride { round_up(width, block_size) }
+    , tiles_x { (width + tile_size - 1) / tile_size }
+    , tiles_y { (height + tile_size - 1) / tile_size }
+    , blocks_x { round_up(width, block_size) / block_size }
+    , use_avx2 { false }
+    , color(static_cast<std::size_t>(this->stride) * round_up(height, block_size))
+    , depth(this->color.size())
+    , block_max_depth(this->color.size() / (block_size * block_size))
+    , view_projection { 1.0f }
+    , bins(static_cast<std::size_t>(this->tiles_x) * this->tiles_y) {
+
+#ifdef SOFTWARE_RASTERIZER_X86
+    this->use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    this->clear(glm::vec3 { 0.0f });
+}
+
+// public
+
+std::optional<SoftwareRasterizer::Texture> SoftwareRasterizer::load_texture(
+    const std::filesystem::path& img_path) {
+
+    stbi_set_flip_vertically_on_load(true);
+
+    int img_w {};
+    int img_h {};
+    int img_nr_channels {};
+    unsigned char* img_data {
+        stbi_load(img_path.c_str(), &img_w, &img_h, &img_nr_channels, 3)
+    };
+    if (img_data == nullptr) {
+        return std::nullopt;
+    }
+
+    Texture texture {
+        .width = img_w,
+        .height = img_h,
+        .rgb = std::vector<unsigned char>(img_data,
+            img_data + static_cast<std::size_t>(img_w) * img_h * 3)
+    };
+    stbi_image_free(img_data);
+    return texture;
+}
+
+int SoftwareRasterizer::width() const {
+    return this->_width;
+}
+
+int SoftwareRasterizer::height() const {
+    return this->_height;
+}
+
+void SoftwareRasterizer::clear(const glm::vec3& color) {
+    std::ranges::fill(this->color, pack_color(color));
+    std::ranges::fill(this->depth, 1.0f);
+    std::ranges::fill(this->block_max_depth, 1.0f);
+
+    this->materials.clear();
+    this->triangles.clear();
+    for (std::vector<std::uint32_t>& bin : this->bins) {
+        bin.clear();
+    }
+}
+
+void SoftwareRasterizer::set_view_projection(const glm::mat4& view_projection) {
+    this->view_projection = view_projection;
+}
+
+void SoftwareRasterizer::draw(const Draw& draw) {
+    const Mesh& mesh { *draw.mesh };
+    const bool textured { draw.material.texture0 != nullptr && mesh.floats_per_vertex >= 5 };
+    const glm::mat4 model_view_projection { this->view_projection * draw.model };
+
+    const std::uint32_t material { static_cast<std::uint32_t>(this->materials.size()) };
+    this->materials.push_back(draw.material);
+
+    this->clip_positions.resize(mesh.vertex_count);
+    this->tex_coords.assign(mesh.vertex_count, glm::vec2 { 0.0f });
+    for (std::size_t i { 0 }; i < mesh.vertex_count; i++) {
+        const float* vertex { &mesh.vertices[i * mesh.floats_per_vertex] };
+        this->clip_positions[i] =
+            model_view_projection * glm::vec4 { vertex[0], vertex[1], vertex[2], 1.0f };
+        if (textured) {
+            this->tex_coords[i] = glm::vec2 { vertex[3], vertex[4] };
+        }
+    }
+
+    for (std::size_t i { 0 }; i + 2 < mesh.index_count; i += 3) {
+        std::array<glm::vec4, 3> clip;
+        std::array<glm::vec2, 3> uv;
+        for (std::size_t corner { 0 }; corner < 3; corner++) {
+            const std::uint32_t index { read_index(mesh, i + corner) };
+            clip[corner] = this->clip_positions[index];
+            uv[corner] = this->tex_coords[index];
+        }
+        this->add_triangle(clip.data(), uv.data(), material);
+    }
+}
+
+void SoftwareRasterizer::finish() {
+    if (this->triangles.empty()) {
+        return;
+    }
+
+    // Tiles write disjoint parts of the buffers.
+    job_system().parallel_for(this->bins.size(), 1,
+        [this](const std::size_t begin, const std::size_t end) {
+            for (std::size_t tile { begin }; tile < end; tile++) {
+                this->rasterize_tile(static_cast<std::uint32_t>(tile));
+            }
+        });
+}
+
+std::uint32_t SoftwareRasterizer::pixel(const int x, const int y) const {
+    return this->color[static_cast<std::size_t>(y) * this->stride + x];
+}
+
+bool SoftwareRasterizer::write_ppm(const std::filesystem::path& path) const {
+    std::ofstream file { path, std::ios::binary };
+    if (!file) {
+        return false;
+    }
+
+    file << "P6\n" << this->_width << ' ' << this->_height << "\n255\n";
+    std::vector<char> row(static_cast<std::size_t>(this->_width) * 3);
+    for (int y { this->_height - 1 }; y >= 0; y--) {
+        for (int x { 0 }; x < this->_width; x++) {
+            const std::uint32_t rgba { this->pixel(x, y) };
+            row[x * 3] = static_cast<char>(rgba & 0xFF);
+            row[x * 3 + 1] = static_cast<char>(rgba >> 8 & 0xFF);
+            row[x * 3 + 2] = static_cast<char>(rgba >> 16 & 0xFF);
+        }
+        file.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+// private
+
+void SoftwareRasterizer::add_triangle(
+    const glm::vec4* clip,
+    const glm::vec2* uv,
+    const std::uint32_t material) {
+
+    // Outside one of the frustum planes with every vertex
+    for (int axis { 0 }; axis < 3; axis++) {
+        if (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w
+            && clip[2][axis] < -clip[2].w) {
+            return;
+        }
+        if (clip[0][axis] > clip[0].w && clip[1][axis] > clip[1].w
+            && clip[2][axis] > clip[2].w) {
+            return;
+        }
+    }
+
+    // Only the near plane is clipped, w stays positive behind it and the other
+    // planes are handled by the screen bounds and the depth test.
+    const std::array<float, 3> distance {
+        clip[0].z + clip[0].w,
+        clip[1].z + clip[1].w,
+        clip[2].z + clip[2].w
+    };
+    if (distance[0] >= 0.0f && distance[1] >= 0.0f && distance[2] >= 0.0f) {
+        this->bin_triangle(clip, uv, material);
+        return;
+    }
+
+    std::array<glm::vec4, 4> clipped;
+    std::array<glm::vec2, 4> clipped_uv;
+    std::size_t count { 0 };
+    for (std::size_t i { 0 }; i < 3; i++) {
+        const std::size_t next { (i + 1) % 3 };
+        if (distance[i] >= 0.0f) {
+            clipped[count] = clip[i];
+            clipped_uv[count] = uv[i];
+            count++;
+        }
+        if ((distance[i] >= 0.0f) != (distance[next] >= 0.0f)) {
+            const float t { distance[i] / (distance[i] - distance[next]) };
+            clipped[count] = glm::mix(clip[i], clip[next], t);
+            clipped_uv[count] = glm::mix(uv[i], uv[next], t);
+            count++;
+        }
+    }
+
+    for (std::size_t i { 1 }; i + 1 < count; i++) {
+        const std::array fan { clipped[0], clipped[i], clipped[i + 1] };
+        const std::array fan_uv { clipped_uv[0], clipped_uv[i], clipped_uv[i + 1] };
+        this->bin_triangle(fan.data(), fan_uv.data(), material);
+    }
+}
+
+void SoftwareRasterizer::bin_triangle(
+    const glm::vec4* clip,
+    const glm::vec2* uv,
+    const std::uint32_t material) {
+
+    std::array<glm::vec2, 3> screen;
+    glm::vec3 depth;
+    glm::vec3 inverse_w;
+    for (std::size_t i { 0 }; i < 3; i++) {
+        inverse_w[i] = 1.0f / clip[i].w;
+        const glm::vec3 ndc { glm::vec3 { clip[i] } * inverse_w[i] };
+        screen[i] = glm::vec2 {
+            (ndc.x * 0.5f + 0.5f) * this->_width,
+            (ndc.y * 0.5f + 0.5f) * this->_height
+        };
+        depth[i] = ndc.z * 0.5f + 0.5f;
+    }
+
+    const float area {
+        (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y)
+        - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y)
+    };
+    if (area == 0.0f) {
+        return;
+    }
+
+    // Pixels whose centers are inside the bounds
+    const glm::vec2 min { glm::min(screen[0], glm::min(screen[1], screen[2])) };
+    const glm::vec2 max { glm::max(screen[0], glm::max(screen[1], screen[2])) };
+    const int min_x { std::max(static_cast<int>(std::ceil(min.x - 0.5f)), 0) };
+    const int min_y { std::max(static_cast<int>(std::ceil(min.y - 0.5f)), 0) };
+    const int max_x { std::min(static_cast<int>(std::floor(max.x - 0.5f)), this->_width - 1) };
+    const int max_y { std::min(static_cast<int>(std::floor(max.y - 0.5f)), this->_height - 1) };
+    if (min_x > max_x || min_y > max_y) {
+        return;
+    }
+
+    // Edge i is opposite vertex i, dividing by the signed area makes it positive
+    // inside for both windings.
+    Triangle triangle {};
+    for (std::size_t i { 0 }; i < 3; i++) {
+        const glm::vec2& from { screen[(i + 1) % 3] };
+        const glm::vec2& to { screen[(i + 2) % 3] };
+        triangle.edge_a[i] = (from.y - to.y) / area;
+        triangle.edge_b[i] = (to.x - from.x) / area;
+        triangle.edge_c[i] = ((to.y - from.y) * from.x - (to.x - from.x) * from.y) / area;
+    }
+
+    const auto plane { [&triangle](const glm::vec3& values) {
+        return glm::vec3 {
+            glm::dot(values, triangle.edge_a),
+            glm::dot(values, triangle.edge_b),
+            glm::dot(values, triangle.edge_c)
+        };
+    } };
+    triangle.depth = plane(depth);
+    triangle.inverse_w = plane(inverse_w);
+    triangle.u_over_w = plane(glm::vec3 { uv[0].x, uv[1].x, uv[2].x } * inverse_w);
+    triangle.v_over_w = plane(glm::vec3 { uv[0].y, uv[1].y, uv[2].y } * inverse_w);
+    triangle.min_depth = std::min({ depth[0], depth[1], depth[2] });
+    triangle.material = material;
+    triangle.min_x = min_x;
+    triangle.min_y = min_y;
+    triangle.max_x = max_x;
+    triangle.max_y = max_y;
+
+    const std::uint32_t index { static_cast<std::uint32_t>(this->triangles.size()) };
+    this->triangles.push_back(triangle);
+    for (int tile_y { min_y / tile_size }; tile_y <= max_y / tile_size; tile_y++) {
+        for (int tile_x { min_x / tile_size }; tile_x <= max_x / tile_size; tile_x++) {
+            this->bins[static_cast<std::size_t>(tile_y) * this->tiles_x + tile_x].push_back(index);
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterize_tile(const std::uint32_t tile) {
+    const int tile_min_x { static_cast<int>(tile % this->tiles_x) * tile_size };
+    const int tile_min_y { static_cast<int>(tile / this->tiles_x) * tile_size };
+    const int tile_max_x { std::min(tile_min_x + tile_size, this->_width) - 1 };
+    const int tile_max_y { std::min(tile_min_y + tile_size, this->_height) - 1 };
+
+    for (const std::uint32_t index : this->bins[tile]) {
+        const Triangle& triangle { this->triangles[index] };
+        const int min_block_x { std::max(triangle.min_x, tile_min_x) / block_size };
+        const int min_block_y { std::max(triangle.min_y, tile_min_y) / block_size };
+        const int max_block_x { std::min(triangle.max_x, tile_max_x) / block_size };
+        const int max_block_y { std::min(triangle.max_y, tile_max_y) / block_size };
+
+        for (int block_y { min_block_y }; block_y <= max_block_y; block_y++) {
+            for (int block_x { min_block_x }; block_x <= max_block_x; block_x++) {
+                // Behind everything drawn in the block so far
+                if (triangle.min_depth
+                    >= this->block_max_depth[static_cast<std::size_t>(block_y) * this->blocks_x + block_x]) {
+                    continue;
+                }
+
+                // Outside an edge at every pixel center of the block
+                const float x { block_x * block_size + 0.5f };
+                const float y { block_y * block_size + 0.5f };
+                const glm::vec3 edge0 { triangle.edge_a.x, triangle.edge_b.x, triangle.edge_c.x };
+                const glm::vec3 edge1 { triangle.edge_a.y, triangle.edge_b.y, triangle.edge_c.y };
+                const glm::vec3 edge2 { triangle.edge_a.z, triangle.edge_b.z, triangle.edge_c.z };
+                if (block_max(edge0, x, y) < 0.0f || block_max(edge1, x, y) < 0.0f
+                    || block_max(edge2, x, y) < 0.0f) {
+                    continue;
+                }
+
+                this->rasterize_block(triangle, block_x, block_y);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterize_block(
+    const Triangle& triangle,
+    const int block_x,
+    const int block_y) {
+
+    const int x { block_x * block_size };
+    const int y { block_y * block_size };
+
+#ifdef SOFTWARE_RASTERIZER_X86
+    const std::uint64_t masks { this->use_avx2
+        ? cover_block_avx2(triangle.edge_a, triangle.edge_b, triangle.edge_c, triangle.depth,
+            this->depth.data(), this->stride, x, y)
+        : cover_block(triangle.edge_a, triangle.edge_b, triangle.edge_c, triangle.depth,
+            this->depth.data(), this->stride, x, y) };
+#else
+    const std::uint64_t masks { cover_block(triangle.edge_a, triangle.edge_b, triangle.edge_c,
+        triangle.depth, this->depth.data(), this->stride, x, y) };
+#endif
+    if (masks == 0) {
+        return;
+    }
+
+    float max_depth { 0.0f };
+    for (int row { 0 }; row < block_size; row++) {
+        const unsigned int mask { static_cast<unsigned int>(masks >> (row * block_size) & 0xFF) };
+        if (mask != 0) {
+            this->shade_row(triangle, x, y + row, mask);
+        }
+        const float* row_depth { &this->depth[static_cast<std::size_t>(y + row) * this->stride + x] };
+        max_depth = std::max(max_depth, *std::max_element(row_depth, row_depth + block_size));
+    }
+    this->block_max_depth[static_cast<std::size_t>(block_y) * this->blocks_x + block_x] = max_depth;
+}
+
+void SoftwareRasterizer::shade_row(
+    const Triangle& triangle,
+    const int x,
+    const int y,
+    unsigned int mask) {
+
+    const Material& material { this->materials[triangle.material] };
+    std::uint32_t* row { &this->color[static_cast<std::size_t>(y) * this->stride + x] };
+
+    if (material.texture0 == nullptr) {
+        const std::uint32_t color { pack_color(material.color) };
+        for (; mask != 0; mask &= mask - 1) {
+            row[std::countr_zero(mask)] = color;
+        }
+        return;
+    }
+
+    const float center_y { y + 0.5f };
+    for (; mask != 0; mask &= mask - 1) {
+        const int column { std::countr_zero(mask) };
+        const float center_x { x + column + 0.5f };
+
+        // Perspective correct texture coordinates
+        const float w { 1.0f / evaluate(triangle.inverse_w, center_x, center_y) };
+        const float u { evaluate(triangle.u_over_w, center_x, center_y) * w };
+        const float v { evaluate(triangle.v_over_w, center_x, center_y) * w };
+
+        glm::vec3 color { sample(*material.texture0, u, v) };
+        if (material.texture1 != nullptr) {
+            color = glm::mix(color, sample(*material.texture1, u, v), material.texture_mix);
+        }
+        row[column] = pack_color(color);
+    }
+}
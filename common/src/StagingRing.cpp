@@ -0,0 +1,141 @@
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "GlState.hpp"
+#include "StagingRing.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
+
+// Constructors
+
+StagingRing::StagingRing(const std::size_t capacity)
+    : _buffer { 0 }
+    , _capacity { capacity }
+    , mapped { nullptr } {
+
+    constexpr GLbitfield flags { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+
+    glGenBuffers(1, &this->_buffer);
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->_buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, this->_capacity, nullptr, flags);
+    this->mapped = static_cast<unsigned char*>(
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, this->_capacity, flags));
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (this->mapped == nullptr) {
+        log_error("Failed to map staging buffer.");
+        quit(1);
+    }
+}
+
+StagingRing::~StagingRing() {
+    for (const Allocation& allocation : this->allocations) {
+        if (allocation.fence != nullptr) {
+            glDeleteSync(allocation.fence);
+        }
+    }
+
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->_buffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    gl_state().delete_buffer(this->_buffer);
+}
+
+// public
+
+unsigned int StagingRing::buffer() const {
+    return this->_buffer;
+}
+
+std::size_t StagingRing::capacity() const {
+    return this->_capacity;
+}
+
+std::optional<StagingRing::Region> StagingRing::try_allocate(const std::size_t size) {
+    if (size > this->_capacity) {
+        return std::nullopt;
+    }
+
+    std::lock_guard lock { this->mutex };
+    const std::optional<std::size_t> offset { this->find_space(size) };
+    if (!offset.has_value()) {
+        return std::nullopt;
+    }
+
+    return this->claim(*offset, size);
+}
+
+void StagingRing::submit(const Region& region) {
+    const GLsync fence { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) };
+
+    std::lock_guard lock { this->mutex };
+    const auto allocation {
+        std::ranges::find(this->allocations, region.offset, &Allocation::offset)
+    };
+    if (allocation == this->allocations.end()) {
+        glDeleteSync(fence);
+        return;
+    }
+    allocation->fence = fence;
+}
+
+void StagingRing::retire() {
+    std::lock_guard lock { this->mutex };
+    while (!this->allocations.empty()) {
+        const Allocation& oldest { this->allocations.front() };
+        if (oldest.fence == nullptr) {
+            break;
+        }
+
+        const GLenum status { glClientWaitSync(oldest.fence, 0, 0) };
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        glDeleteSync(oldest.fence);
+        this->allocations.pop_front();
+    }
+}
+
+// private
+
+StagingRing::Region StagingRing::claim(const std::size_t offset, const std::size_t size) {
+    this->allocations.push_back(Allocation {
+        .offset = offset,
+        .size = size,
+        .fence = nullptr });
+
+    return Region {
+        .offset = offset,
+        .size = size,
+        .data = this->mapped + offset
+    };
+}
+
+std::optional<std::size_t> StagingRing::find_space(const std::size_t size) const {
+    if (this->allocations.empty()) {
+        return 0;
+    }
+
+    const std::size_t tail { this->allocations.front().offset };
+    const Allocation& newest { this->allocations.back() };
+    const std::size_t head {
+        (newest.offset + newest.size + alignment - 1) & ~(alignment - 1)
+    };
+
+    if (head > tail) {
+        // Free space is [head, capacity) and [0, tail).
+        if (head + size <= this->_capacity) {
+            return head;
+        }
+        if (size <= tail) {
+            return 0;
+        }
+    } else if (head + size <= tail) {
+        // Wrapped around, free space is [head, tail).
+        return head;
+    }
+
+    return std::nullopt;
+}
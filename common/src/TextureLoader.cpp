@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+#include "stb_image.h"
+
+#include "glad/glad.h"
+
+#include "GlState.hpp"
+#include "JobSystem.hpp"
+#include "TextureLoader.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
+
+// Constructors
+
+TextureLoader::TextureLoader(const std::size_t staging_size)
+    : staging { staging_size }
+    , in_flight { 0 } {
+
+    // The flip flag is global in stb_image, set it before any job reads it.
+    stbi_set_flip_vertically_on_load(true);
+}
+
+TextureLoader::~TextureLoader() {
+    job_system().wait(this->decodes);
+}
+
+// public
+
+unsigned int TextureLoader::load(
+    const std::filesystem::path& img_path,
+    const int gl_pixel_data_format) {
+
+    if (!std::filesystem::exists(img_path)) {
+        log_error(std::format("The given image file '{}' does not exist.",
+            img_path.c_str())
+                .c_str());
+        quit(1);
+    }
+
+    // Placeholder until the decoded image is uploaded.
+    constexpr unsigned char placeholder_pixel[] { 255, 0, 255 };
+
+    unsigned int texture {};
+    glGenTextures(1, &texture);
+
+    gl_state().bind_texture(upload_texture_unit, GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE,
+        placeholder_pixel);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // In the background so a frame waiting on its own jobs never runs a decode.
+    job_system().submit_background(
+        [this, request = Request {
+                   .texture = texture,
+                   .img_path = img_path,
+                   .gl_pixel_data_format = gl_pixel_data_format }]() mutable {
+            this->decode(std::move(request));
+        },
+        &this->decodes);
+    this->in_flight++;
+
+    return texture;
+}
+
+void TextureLoader::upload_pending(const std::size_t byte_budget) {
+    this->staging.retire();
+
+    if (this->in_flight == 0) {
+        return;
+    }
+
+    std::vector<DecodedImage> ready;
+    {
+        std::lock_guard lock { this->decoded_mutex };
+        std::size_t budget_left { byte_budget };
+        auto it { this->decoded.begin() };
+        for (; it != this->decoded.end(); it++) {
+            const std::size_t size {
+                static_cast<std::size_t>(it->width) * it->height * it->channels
+            };
+            if (it != this->decoded.begin() && size > budget_left) {
+                break;
+            }
+            budget_left -= std::min(size, budget_left);
+        }
+        ready.assign(std::make_move_iterator(this->decoded.begin()),
+            std::make_move_iterator(it));
+        this->decoded.erase(this->decoded.begin(), it);
+    }
+
+    // Rows of RGB images are not padded to four bytes.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (const DecodedImage& image : ready) {
+        if (image.pixels == nullptr && !image.staging.has_value()) {
+            log_error(std::format("Failed to load image '{}'.",
+                image.request.img_path.c_str())
+                    .c_str());
+            quit(1);
+        }
+
+        gl_state().bind_texture(upload_texture_unit, GL_TEXTURE_2D, image.request.texture);
+        if (image.staging.has_value()) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0,
+                image.request.gl_pixel_data_format, GL_UNSIGNED_BYTE, nullptr);
+
+            gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->staging.buffer());
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height,
+                image.request.gl_pixel_data_format, GL_UNSIGNED_BYTE,
+                reinterpret_cast<const void*>(image.staging->offset));
+            gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            this->staging.submit(*image.staging);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0,
+                image.request.gl_pixel_data_format, GL_UNSIGNED_BYTE, image.pixels.get());
+        }
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    this->in_flight -= ready.size();
+}
+
+std::size_t TextureLoader::pending_count() const {
+    return this->in_flight;
+}
+
+// private
+
+void TextureLoader::PixelsDeleter::operator()(unsigned char* pixels) const {
+    stbi_image_free(pixels);
+}
+
+void TextureLoader::decode(Request request) {
+    int img_w {};
+    int img_h {};
+    int img_nr_channels {};
+    std::unique_ptr<unsigned char, PixelsDeleter> img_data {
+        stbi_load(request.img_path.c_str(), &img_w, &img_h, &img_nr_channels, 0)
+    };
+
+    // Jobs must not block, images are uploaded from memory while the ring is full.
+    std::optional<StagingRing::Region> staging_region {};
+    if (img_data != nullptr) {
+        const std::size_t size {
+            static_cast<std::size_t>(img_w) * img_h * img_nr_channels
+        };
+        staging_region = this->staging.try_allocate(size);
+        if (staging_region.has_value()) {
+            std::memcpy(staging_region->data, img_data.get(), size);
+            img_data.reset();
+        }
+    }
+
+    std::lock_guard lock { this->decoded_mutex };
+    this->decoded.push_back(DecodedImage {
+        .request = std::move(request),
+        .width = img_w,
+        .height = img_h,
+        .channels = img_nr_channels,
+        .pixels = std::move(img_data),
+        .staging = staging_region });
+}
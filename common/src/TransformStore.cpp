@@ -0,0 +1,269 @@
+#include <cstring>
+#include <initializer_list>
+
+#include "JobSystem.hpp"
+#include "TransformStore.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSFORM_SIMD
+
+using Lanes = __m256;
+static constexpr std::size_t lane_count { 8 };
+
+static Lanes load(const float* values) { return _mm256_loadu_ps(values); }
+static Lanes broadcast(const float value) { return _mm256_set1_ps(value); }
+static Lanes add(const Lanes a, const Lanes b) { return _mm256_add_ps(a, b); }
+static Lanes sub(const Lanes a, const Lanes b) { return _mm256_sub_ps(a, b); }
+static Lanes mul(const Lanes a, const Lanes b) { return _mm256_mul_ps(a, b); }
+
+// Writes column of the matrices of eight objects, rows a to d hold one object
+// per lane.
+static void store_column(
+    const std::size_t column,
+    const Lanes a,
+    const Lanes b,
+    const Lanes c,
+    const Lanes d,
+    std::byte* out,
+    const std::size_t stride) {
+
+    const __m256 ab_low { _mm256_unpacklo_ps(a, b) };
+    const __m256 ab_high { _mm256_unpackhi_ps(a, b) };
+    const __m256 cd_low { _mm256_unpacklo_ps(c, d) };
+    const __m256 cd_high { _mm256_unpackhi_ps(c, d) };
+    // Objects 0 to 3 in the low halves, 4 to 7 in the high ones
+    const __m256 objects[4] {
+        _mm256_shuffle_ps(ab_low, cd_low, 0x44),
+        _mm256_shuffle_ps(ab_low, cd_low, 0xEE),
+        _mm256_shuffle_ps(ab_high, cd_high, 0x44),
+        _mm256_shuffle_ps(ab_high, cd_high, 0xEE)
+    };
+    for (std::size_t object { 0 }; object < 4; object++) {
+        float* low { reinterpret_cast<float*>(out + object * stride) + column * 4 };
+        float* high { reinterpret_cast<float*>(out + (object + 4) * stride) + column * 4 };
+        _mm_storeu_ps(low, _mm256_castps256_ps128(objects[object]));
+        _mm_storeu_ps(high, _mm256_extractf128_ps(objects[object], 1));
+    }
+}
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_SIMD
+
+using Lanes = __m128;
+static constexpr std::size_t lane_count { 4 };
+
+static Lanes load(const float* values) { return _mm_loadu_ps(values); }
+static Lanes broadcast(const float value) { return _mm_set1_ps(value); }
+static Lanes add(const Lanes a, const Lanes b) { return _mm_add_ps(a, b); }
+static Lanes sub(const Lanes a, const Lanes b) { return _mm_sub_ps(a, b); }
+static Lanes mul(const Lanes a, const Lanes b) { return _mm_mul_ps(a, b); }
+
+static void store_column(
+    const std::size_t column,
+    Lanes a,
+    Lanes b,
+    Lanes c,
+    Lanes d,
+    std::byte* out,
+    const std::size_t stride) {
+
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(reinterpret_cast<float*>(out) + column * 4, a);
+    _mm_storeu_ps(reinterpret_cast<float*>(out + stride) + column * 4, b);
+    _mm_storeu_ps(reinterpret_cast<float*>(out + 2 * stride) + column * 4, c);
+    _mm_storeu_ps(reinterpret_cast<float*>(out + 3 * stride) + column * 4, d);
+}
+#endif
+
+// Objects per job, a multiple of every lane count.
+static constexpr std::size_t parallel_chunk_size { 16 * 1024 };
+
+// public
+
+void TransformStore::reserve(const std::size_t count) {
+    for (std::vector<float>* values : {
+             &this->position_x, &this->position_y, &this->position_z,
+             &this->rotation_x, &this->rotation_y, &this->rotation_z, &this->rotation_w,
+             &this->scale_x, &this->scale_y, &this->scale_z }) {
+        values->reserve(count);
+    }
+}
+
+std::size_t TransformStore::size() const {
+    return this->position_x.size();
+}
+
+TransformStore::Index TransformStore::add(
+    const glm::vec3& position,
+    const glm::quat& rotation,
+    const glm::vec3& scale) {
+
+    const Index index { static_cast<Index>(this->size()) };
+    this->position_x.push_back(position.x);
+    this->position_y.push_back(position.y);
+    this->position_z.push_back(position.z);
+    this->rotation_x.push_back(rotation.x);
+    this->rotation_y.push_back(rotation.y);
+    this->rotation_z.push_back(rotation.z);
+    this->rotation_w.push_back(rotation.w);
+    this->scale_x.push_back(scale.x);
+    this->scale_y.push_back(scale.y);
+    this->scale_z.push_back(scale.z);
+    return index;
+}
+
+glm::vec3 TransformStore::position(const Index index) const {
+    return glm::vec3 {
+        this->position_x[index], this->position_y[index], this->position_z[index]
+    };
+}
+
+glm::quat TransformStore::rotation(const Index index) const {
+    return glm::quat {
+        this->rotation_w[index],
+        this->rotation_x[index],
+        this->rotation_y[index],
+        this->rotation_z[index]
+    };
+}
+
+glm::vec3 TransformStore::scale(const Index index) const {
+    return glm::vec3 { this->scale_x[index], this->scale_y[index], this->scale_z[index] };
+}
+
+void TransformStore::set_position(const Index index, const glm::vec3& position) {
+    this->position_x[index] = position.x;
+    this->position_y[index] = position.y;
+    this->position_z[index] = position.z;
+}
+
+void TransformStore::set_rotation(const Index index, const glm::quat& rotation) {
+    this->rotation_x[index] = rotation.x;
+    this->rotation_y[index] = rotation.y;
+    this->rotation_z[index] = rotation.z;
+    this->rotation_w[index] = rotation.w;
+}
+
+void TransformStore::set_scale(const Index index, const glm::vec3& scale) {
+    this->scale_x[index] = scale.x;
+    this->scale_y[index] = scale.y;
+    this->scale_z[index] = scale.z;
+}
+
+void TransformStore::write_model_matrices(
+    const Index first,
+    const std::size_t count,
+    glm::mat4* out,
+    const std::size_t stride) const {
+
+    std::byte* bytes { reinterpret_cast<std::byte*>(out) };
+    if (count <= parallel_chunk_size) {
+        this->write_range(first, first + count, bytes, stride);
+        return;
+    }
+
+    job_system().parallel_for(count, parallel_chunk_size,
+        [this, first, bytes, stride](const std::size_t begin, const std::size_t end) {
+            this->write_range(first + begin, first + end, bytes + begin * stride, stride);
+        });
+}
+
+void TransformStore::write_model_matrices(std::span<glm::mat4> out) const {
+    this->write_model_matrices(0, out.size(), out.data());
+}
+
+// private
+
+void TransformStore::write_range(
+    const std::size_t begin,
+    const std::size_t end,
+    std::byte* out,
+    const std::size_t stride) const {
+
+    std::size_t i { begin };
+
+#ifdef TRANSFORM_SIMD
+    const Lanes zero { broadcast(0.0f) };
+    const Lanes one { broadcast(1.0f) };
+    const Lanes two { broadcast(2.0f) };
+
+    for (; i + lane_count <= end; i += lane_count, out += lane_count * stride) {
+        const Lanes x { load(this->rotation_x.data() + i) };
+        const Lanes y { load(this->rotation_y.data() + i) };
+        const Lanes z { load(this->rotation_z.data() + i) };
+        const Lanes w { load(this->rotation_w.data() + i) };
+
+        // Doubled so the products below need no further scaling
+        const Lanes x2 { mul(x, two) };
+        const Lanes y2 { mul(y, two) };
+        const Lanes z2 { mul(z, two) };
+        const Lanes xx { mul(x, x2) };
+        const Lanes yy { mul(y, y2) };
+        const Lanes zz { mul(z, z2) };
+        const Lanes xy { mul(x, y2) };
+        const Lanes xz { mul(x, z2) };
+        const Lanes yz { mul(y, z2) };
+        const Lanes wx { mul(w, x2) };
+        const Lanes wy { mul(w, y2) };
+        const Lanes wz { mul(w, z2) };
+
+        const Lanes sx { load(this->scale_x.data() + i) };
+        const Lanes sy { load(this->scale_y.data() + i) };
+        const Lanes sz { load(this->scale_z.data() + i) };
+
+        // ::add is the lane addition, not TransformStore::add
+        store_column(0,
+            mul(sub(one, ::add(yy, zz)), sx),
+            mul(::add(xy, wz), sx),
+            mul(sub(xz, wy), sx),
+            zero,
+            out, stride);
+        store_column(1,
+            mul(sub(xy, wz), sy),
+            mul(sub(one, ::add(xx, zz)), sy),
+            mul(::add(yz, wx), sy),
+            zero,
+            out, stride);
+        store_column(2,
+            mul(::add(xz, wy), sz),
+            mul(sub(yz, wx), sz),
+            mul(sub(one, ::add(xx, yy)), sz),
+            zero,
+            out, stride);
+        store_column(3,
+            load(this->position_x.data() + i),
+            load(this->position_y.data() + i),
+            load(this->position_z.data() + i),
+            one,
+            out, stride);
+    }
+#endif
+
+    for (; i < end; i++, out += stride) {
+        const float x { this->rotation_x[i] };
+        const float y { this->rotation_y[i] };
+        const float z { this->rotation_z[i] };
+        const float w { this->rotation_w[i] };
+        const float sx { this->scale_x[i] };
+        const float sy { this->scale_y[i] };
+        const float sz { this->scale_z[i] };
+
+        const glm::mat4 model {
+            glm::vec4 { (1.0f - 2.0f * (y * y + z * z)) * sx,
+                2.0f * (x * y + w * z) * sx,
+                2.0f * (x * z - w * y) * sx,
+                0.0f },
+            glm::vec4 { 2.0f * (x * y - w * z) * sy,
+                (1.0f - 2.0f * (x * x + z * z)) * sy,
+                2.0f * (y * z + w * x) * sy,
+                0.0f },
+            glm::vec4 { 2.0f * (x * z + w * y) * sz,
+                2.0f * (y * z - w * x) * sz,
+                (1.0f - 2.0f * (x * x + y * y)) * sz,
+                0.0f },
+            glm::vec4 { this->position_x[i], this->position_y[i], this->position_z[i], 1.0f }
+        };
+        std::memcpy(out, &model, sizeof(model));
+    }
+}
@@ -0,0 +1,245 @@
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "JobSystem.hpp"
+#include "culling.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_SIMD
+
+using Lanes = __m256;
+static constexpr std::size_t lane_count { 8 };
+
+static Lanes load(const float* values) { return _mm256_loadu_ps(values); }
+static Lanes broadcast(const float value) { return _mm256_set1_ps(value); }
+static Lanes add(const Lanes a, const Lanes b) { return _mm256_add_ps(a, b); }
+static Lanes mul(const Lanes a, const Lanes b) { return _mm256_mul_ps(a, b); }
+static Lanes greater_equal(const Lanes a, const Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static Lanes both(const Lanes a, const Lanes b) { return _mm256_and_ps(a, b); }
+static unsigned int to_bits(const Lanes mask) { return _mm256_movemask_ps(mask); }
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define CULLING_SIMD
+
+using Lanes = __m128;
+static constexpr std::size_t lane_count { 4 };
+
+static Lanes load(const float* values) { return _mm_loadu_ps(values); }
+static Lanes broadcast(const float value) { return _mm_set1_ps(value); }
+static Lanes add(const Lanes a, const Lanes b) { return _mm_add_ps(a, b); }
+static Lanes mul(const Lanes a, const Lanes b) { return _mm_mul_ps(a, b); }
+static Lanes greater_equal(const Lanes a, const Lanes b) { return _mm_cmpge_ps(a, b); }
+static Lanes both(const Lanes a, const Lanes b) { return _mm_and_ps(a, b); }
+static unsigned int to_bits(const Lanes mask) { return _mm_movemask_ps(mask); }
+#endif
+
+#ifdef CULLING_SIMD
+static Lanes all_lanes() {
+    const Lanes zero { broadcast(0.0f) };
+    return greater_equal(zero, zero);
+}
+#endif
+
+// Objects tested per job, smaller counts are culled on the calling thread.
+static constexpr std::size_t parallel_chunk_size { 16 * 1024 };
+
+// Signed distance from the plane, positive on the inside.
+static float plane_distance(
+    const glm::vec4& plane,
+    const float x,
+    const float y,
+    const float z) {
+
+    return plane.x * x + plane.y * y + plane.z * z + plane.w;
+}
+
+#ifdef CULLING_SIMD
+static Lanes plane_distance(
+    const glm::vec4& plane,
+    const Lanes x,
+    const Lanes y,
+    const Lanes z) {
+
+    Lanes distance { mul(broadcast(plane.x), x) };
+    distance = add(distance, mul(broadcast(plane.y), y));
+    distance = add(distance, mul(broadcast(plane.z), z));
+    return add(distance, broadcast(plane.w));
+}
+
+static std::size_t append_indices(
+    unsigned int bits,
+    const std::size_t first_index,
+    std::uint32_t* out) {
+
+    std::size_t written { 0 };
+    while (bits != 0) {
+        out[written++] = static_cast<std::uint32_t>(first_index + std::countr_zero(bits));
+        bits &= bits - 1;
+    }
+    return written;
+}
+#endif
+
+// Writes the indices of the visible objects in [begin, end) to out and returns
+// how many there are.
+static std::size_t cull_spheres_range(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    const std::size_t begin,
+    const std::size_t end,
+    std::uint32_t* out) {
+
+    std::size_t visible_count { 0 };
+    std::size_t i { begin };
+
+#ifdef CULLING_SIMD
+    for (; i + lane_count <= end; i += lane_count) {
+        const Lanes x { load(spheres.center_x + i) };
+        const Lanes y { load(spheres.center_y + i) };
+        const Lanes z { load(spheres.center_z + i) };
+        const Lanes negative_radius { mul(load(spheres.radius + i), broadcast(-1.0f)) };
+
+        Lanes inside { all_lanes() };
+        for (const glm::vec4& plane : frustum.planes) {
+            inside = both(inside,
+                greater_equal(plane_distance(plane, x, y, z), negative_radius));
+        }
+
+        visible_count += append_indices(to_bits(inside), i, out + visible_count);
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside { true };
+        for (const glm::vec4& plane : frustum.planes) {
+            const float distance {
+                plane_distance(plane, spheres.center_x[i], spheres.center_y[i], spheres.center_z[i])
+            };
+            inside = inside && distance >= -spheres.radius[i];
+        }
+        if (inside) {
+            out[visible_count++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    return visible_count;
+}
+
+static std::size_t cull_boxes_range(
+    const Frustum& frustum,
+    const std::array<glm::vec3, Frustum::PLANE_COUNT>& abs_normals,
+    const BoundingBoxes& boxes,
+    const std::size_t begin,
+    const std::size_t end,
+    std::uint32_t* out) {
+
+    std::size_t visible_count { 0 };
+    std::size_t i { begin };
+
+#ifdef CULLING_SIMD
+    for (; i + lane_count <= end; i += lane_count) {
+        const Lanes x { load(boxes.center_x + i) };
+        const Lanes y { load(boxes.center_y + i) };
+        const Lanes z { load(boxes.center_z + i) };
+        const Lanes extent_x { load(boxes.extent_x + i) };
+        const Lanes extent_y { load(boxes.extent_y + i) };
+        const Lanes extent_z { load(boxes.extent_z + i) };
+
+        Lanes inside { all_lanes() };
+        for (std::size_t plane { 0 }; plane < Frustum::PLANE_COUNT; plane++) {
+            const glm::vec3& abs_normal { abs_normals[plane] };
+            Lanes negative_radius { mul(broadcast(-abs_normal.x), extent_x) };
+            negative_radius = add(negative_radius, mul(broadcast(-abs_normal.y), extent_y));
+            negative_radius = add(negative_radius, mul(broadcast(-abs_normal.z), extent_z));
+            inside = both(inside,
+                greater_equal(plane_distance(frustum.planes[plane], x, y, z), negative_radius));
+        }
+
+        visible_count += append_indices(to_bits(inside), i, out + visible_count);
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside { true };
+        for (std::size_t plane { 0 }; plane < Frustum::PLANE_COUNT; plane++) {
+            const float distance {
+                plane_distance(frustum.planes[plane], boxes.center_x[i], boxes.center_y[i], boxes.center_z[i])
+            };
+            const float radius {
+                abs_normals[plane].x * boxes.extent_x[i]
+                + abs_normals[plane].y * boxes.extent_y[i]
+                + abs_normals[plane].z * boxes.extent_z[i]
+            };
+            inside = inside && distance >= -radius;
+        }
+        if (inside) {
+            out[visible_count++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    return visible_count;
+}
+
+// Culls chunks of the objects on the job system, each chunk writes its indices
+// to its own part of visible, and packs the parts together in order.
+template <typename CullRange>
+static void cull_parallel(
+    const std::size_t count,
+    std::vector<std::uint32_t>& visible,
+    const CullRange& cull_range) {
+
+    visible.resize(count);
+    if (count <= parallel_chunk_size) {
+        visible.resize(cull_range(0, count, visible.data()));
+        return;
+    }
+
+    std::vector<std::size_t> chunk_counts((count + parallel_chunk_size - 1) / parallel_chunk_size);
+    job_system().parallel_for(count, parallel_chunk_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            chunk_counts[begin / parallel_chunk_size] =
+                cull_range(begin, end, visible.data() + begin);
+        });
+
+    std::size_t visible_count { chunk_counts[0] };
+    for (std::size_t chunk { 1 }; chunk < chunk_counts.size(); chunk++) {
+        std::memmove(visible.data() + visible_count, visible.data() + chunk * parallel_chunk_size,
+            chunk_counts[chunk] * sizeof(std::uint32_t));
+        visible_count += chunk_counts[chunk];
+    }
+    visible.resize(visible_count);
+}
+
+void cull_spheres(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    std::vector<std::uint32_t>& visible) {
+
+    cull_parallel(spheres.count, visible,
+        [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+            return cull_spheres_range(frustum, spheres, begin, end, out);
+        });
+}
+
+void cull_boxes(
+    const Frustum& frustum,
+    const BoundingBoxes& boxes,
+    std::vector<std::uint32_t>& visible) {
+
+    // A box is outside a plane when its center is further out than the extent
+    // projected onto the plane normal.
+    std::array<glm::vec3, Frustum::PLANE_COUNT> abs_normals {};
+    for (std::size_t plane { 0 }; plane < Frustum::PLANE_COUNT; plane++) {
+        abs_normals[plane] = glm::vec3 {
+            std::abs(frustum.planes[plane].x),
+            std::abs(frustum.planes[plane].y),
+            std::abs(frustum.planes[plane].z) };
+    }
+
+    cull_parallel(boxes.count, visible,
+        [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+            return cull_boxes_range(frustum, abs_normals, boxes, begin, end, out);
+        });
+}
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <format>
+#include <print>
+
+#include "error_handling.hpp"
+#include "frame_dump.hpp"
+#include "quit.hpp"
+
+void print_frame_times(std::vector<float> frame_times) {
+    if (frame_times.empty()) {
+        return;
+    }
+
+    std::ranges::sort(frame_times);
+    float total_ms { 0.0f };
+    for (const float frame_time : frame_times) {
+        total_ms += frame_time;
+    }
+    std::println("frames: {}, mean: {:.3f} ms, median: {:.3f} ms, min: {:.3f} ms, max: {:.3f} ms",
+        frame_times.size(),
+        total_ms / frame_times.size(),
+        frame_times[frame_times.size() / 2],
+        frame_times.front(),
+        frame_times.back());
+}
+
+void dump_frame(const SoftwareRasterizer& rasterizer, const std::filesystem::path& image_path) {
+    if (!rasterizer.write_ppm(image_path)) {
+        log_error(std::format("Failed to write '{}'.", image_path.c_str()).c_str());
+        quit(1);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Frustum.hpp"
+
+class Camera {
+public:
+    enum class Direction {
+        FORWARD,
+        BACKWARD,
+        LEFT,
+        RIGHT
+    };
+
+    float move_speed;
+    float mouse_sensitivity;
+    float pitch_min;
+    float pitch_max;
+    float fov_min;
+    float fov_max;
+
+    Camera(
+        glm::vec3 position,
+        float fov_deg,
+        float fov_max,
+        float move_speed,
+        float mouse_sensitivity,
+        float fov_min = 0.0f,
+        float pitch_min = -89.0f,
+        float pitch_max = 89.0f,
+        glm::vec3 up = { 0.0f, 1.0f, 0.0f },
+        glm::vec3 world_up = { 0.0f, 1.0f, 0.0f },
+        float pitch_deg = 0.0f,
+        float yaw_deg = -90.0f);
+
+    float get_fov_rad() const;
+
+    // Lens of the projection matrices, they are only invalidated when it changes.
+    void set_perspective(
+        const float aspect_ratio,
+        const float near_plane,
+        const float far_plane);
+
+    // Vectors and matrices are recomputed on first use after the camera changed
+    // and cached until the next change, so querying them again is free.
+    const glm::vec3& get_position() const;
+    const glm::vec3& get_front() const;
+    const glm::vec3& get_right() const;
+    const glm::vec3& get_up() const;
+
+    const glm::mat4& get_view_matrix() const;
+    const glm::mat4& get_inverse_view_matrix() const;
+    const glm::mat4& get_projection_matrix() const;
+    const glm::mat4& get_inverse_projection_matrix() const;
+    const glm::mat4& get_view_projection_matrix() const;
+    const glm::mat4& get_inverse_view_projection_matrix() const;
+
+    const Frustum& get_frustum() const;
+
+    void move_to_direction(
+        const Camera::Direction direction,
+        const float delta_time);
+
+    void process_mouse_move(
+        float offset_x,
+        float offset_y,
+        const bool constrain_pitch = true);
+
+    void process_mouse_scroll(float offset_y);
+
+private:
+    // Cached values that have to be recomputed
+    enum Dirty : unsigned int {
+        VECTORS = 1 << 0,
+        VIEW = 1 << 1,
+        PROJECTION = 1 << 2,
+        VIEW_PROJECTION = 1 << 3,
+        FRUSTUM = 1 << 4
+    };
+
+    glm::vec3 pos;
+    glm::vec3 world_up;
+    float fov_deg;
+    float pitch_deg;
+    float yaw_deg;
+    float aspect_ratio;
+    float near_plane;
+    float far_plane;
+
+    mutable unsigned int dirty;
+    mutable glm::vec3 front;
+    mutable glm::vec3 up;
+    mutable glm::vec3 right;
+    mutable glm::mat4 view;
+    mutable glm::mat4 inverse_view;
+    mutable glm::mat4 projection;
+    mutable glm::mat4 inverse_projection;
+    mutable glm::mat4 view_projection;
+    mutable glm::mat4 inverse_view_projection;
+    mutable Frustum frustum;
+
+    void update_vectors() const;
+    void update_view() const;
+    void update_projection() const;
+    void update_view_projection() const;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "glad/glad.h"
+
+#include "SoftwareRasterizer.hpp"
+#include "mesh.hpp"
+
+// Collects the draws of a frame and issues them ordered by a 64-bit sort key so
+// draws sharing a program, material and vertex array run back to back.
+//
+// Key layout, most significant first:
+//   opaque:      pass 4 | program 12 | material 16 | vertex array 12 | depth 20
+//   translucent: pass 4 | inverted depth 20 | program 12 | material 16 | vertex array 12
+// Names wider than their field are truncated, that only makes the grouping coarser.
+//
+// A queue created with a SoftwareRasterizer issues the same draws on the CPU, so a
+// render loop runs unchanged without a GL context.
+class DrawQueue {
+public:
+    static constexpr std::size_t max_material_textures { 4 };
+
+    enum class Pass : std::uint8_t {
+        OPAQUE,
+        TRANSLUCENT
+    };
+
+    struct Draw {
+        Pass pass;
+        unsigned int program;
+        // Chosen by the caller, draws with the same material use the same textures.
+        std::uint16_t material;
+        // Bound to units 0 to max_material_textures - 1, 0 leaves a unit alone.
+        std::array<unsigned int, max_material_textures> textures;
+        unsigned int vertex_array;
+        // View space distance in [0, 1], nearest first for opaque draws and
+        // farthest first for translucent ones.
+        float depth;
+
+        GLenum mode;
+        GLsizei index_count;
+        GLenum index_type;
+        std::size_t index_offset;
+        int base_vertex;
+        GLsizei instance_count;
+
+        // Buffer range bound at the queue's object block binding, skipped if size
+        // is 0.
+        unsigned int object_buffer;
+        std::size_t object_offset;
+        std::size_t object_size;
+
+        // Read by the software backend in place of the GL names and ranges above,
+        // the whole mesh is drawn once per model matrix. Both have to outlive
+        // submit().
+        const Mesh* mesh;
+        std::span<const glm::mat4> models;
+    };
+
+    // object_block_target is GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER.
+    DrawQueue(const GLenum object_block_target, const unsigned int object_block_binding);
+    explicit DrawQueue(SoftwareRasterizer& rasterizer);
+
+    // How the software backend shades draws of the given material, ignored by
+    // the GL backend.
+    void set_software_material(
+        const std::uint16_t material,
+        const SoftwareRasterizer::Material& software_material);
+
+    void push(const Draw& draw);
+
+    // Sorts and issues the draws pushed since the last call, then empties the queue.
+    void submit();
+
+    std::size_t size() const;
+
+    static std::uint64_t make_key(const Draw& draw);
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t draw;
+    };
+
+    GLenum object_block_target;
+    unsigned int object_block_binding;
+    // Null for the GL backend
+    SoftwareRasterizer* rasterizer;
+    // Indexed by material
+    std::vector<SoftwareRasterizer::Material> software_materials;
+    std::vector<Draw> draws;
+    std::vector<SortEntry> entries;
+    // Kept between frames so sorting does not allocate.
+    std::vector<SortEntry> scratch;
+
+    void sort();
+    void submit_gl() const;
+    void submit_software() const;
+};
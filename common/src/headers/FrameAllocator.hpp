@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "glad/glad.h"
+
+// Hands out aligned slices of one persistently mapped buffer for data that only
+// lives for a frame. The buffer holds frame_count frames, and a frame's region is
+// reused once the fence placed at the end of that frame has signaled.
+class FrameAllocator {
+public:
+    static constexpr std::size_t frame_count { 3 };
+
+    struct Slice {
+        std::size_t offset;
+        std::size_t size;
+        void* data;
+    };
+
+    // Must be created on the thread owning the GL context.
+    explicit FrameAllocator(const std::size_t frame_size);
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    ~FrameAllocator();
+
+    unsigned int buffer() const;
+
+    // Waits until the GPU is done with the region of the frame being started.
+    void begin_frame();
+    void end_frame();
+
+    Slice allocate(const std::size_t size);
+
+    template <typename T>
+    Slice push(const T& value) {
+        const Slice slice { this->allocate(sizeof(T)) };
+        std::memcpy(slice.data, &value, sizeof(T));
+        return slice;
+    }
+
+    // glBindBufferRange for GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER.
+    void bind(const Slice& slice, const GLenum target, const unsigned int binding) const;
+
+private:
+    unsigned int _buffer;
+    unsigned char* mapped;
+    std::size_t frame_size;
+    std::size_t alignment;
+
+    std::array<GLsync, frame_count> fences;
+    std::size_t frame_index;
+    std::size_t frame_used;
+};
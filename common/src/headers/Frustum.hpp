@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+// Planes are stored as (normal, distance) with normals pointing inwards, so a point
+// is inside a plane when dot(normal, point) + distance >= 0.
+struct Frustum {
+    enum Plane {
+        LEFT,
+        RIGHT,
+        BOTTOM,
+        TOP,
+        NEAR,
+        FAR,
+        PLANE_COUNT
+    };
+
+    std::array<glm::vec4, PLANE_COUNT> planes;
+
+    static Frustum from_view_projection(const glm::mat4& view_projection);
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "glad/glad.h"
+
+// Shadow copy of the GL state the renderer changes most often. Calls that would
+// leave the state unchanged are skipped. State changed behind its back with raw gl
+// calls is not seen, call invalidate() after such code.
+class GlState {
+public:
+    struct Counters {
+        std::uint64_t issued;
+        std::uint64_t elided;
+    };
+
+    static constexpr std::size_t max_texture_units { 32 };
+    static constexpr std::size_t max_indexed_buffer_bindings { 16 };
+
+    GlState();
+
+    GlState(const GlState&) = delete;
+    GlState& operator=(const GlState&) = delete;
+
+    // Forgets everything, the next change of each state is always issued.
+    void invalidate();
+
+    const Counters& counters() const;
+    void reset_counters();
+
+    void use_program(const unsigned int program);
+    void bind_vertex_array(const unsigned int vertex_array);
+    void bind_buffer(const GLenum target, const unsigned int buffer);
+    // Indexed GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER bindings.
+    void bind_buffer_range(
+        const GLenum target,
+        const unsigned int index,
+        const unsigned int buffer,
+        const GLintptr offset,
+        const GLsizeiptr size);
+    void bind_texture(const unsigned int unit, const GLenum target, const unsigned int texture);
+    void bind_sampler(const unsigned int unit, const unsigned int sampler);
+
+    void set_enabled(const GLenum capability, const bool enabled);
+    void blend_func(const GLenum source_factor, const GLenum destination_factor);
+    void depth_func(const GLenum func);
+    void depth_mask(const bool enabled);
+    void viewport(const int x, const int y, const int width, const int height);
+
+    // Delete objects and drop them from the shadow state so their names can be
+    // reused by new objects.
+    void delete_program(const unsigned int program);
+    void delete_vertex_array(const unsigned int vertex_array);
+    void delete_buffer(const unsigned int buffer);
+    void delete_texture(const unsigned int texture);
+
+private:
+    // Name used for state that is not known, never a valid GL name.
+    static constexpr unsigned int unknown { 0xFFFFFFFF };
+
+    static constexpr std::array buffer_targets {
+        GL_ARRAY_BUFFER,
+        GL_ELEMENT_ARRAY_BUFFER,
+        GL_UNIFORM_BUFFER,
+        GL_SHADER_STORAGE_BUFFER,
+        GL_DRAW_INDIRECT_BUFFER,
+        GL_DISPATCH_INDIRECT_BUFFER,
+        GL_PARAMETER_BUFFER,
+        GL_PIXEL_UNPACK_BUFFER,
+        GL_PIXEL_PACK_BUFFER,
+        GL_COPY_READ_BUFFER,
+        GL_COPY_WRITE_BUFFER,
+    };
+    static constexpr std::array texture_targets {
+        GL_TEXTURE_2D,
+        GL_TEXTURE_2D_ARRAY,
+        GL_TEXTURE_3D,
+        GL_TEXTURE_CUBE_MAP,
+    };
+    static constexpr std::array capabilities {
+        GL_DEPTH_TEST,
+        GL_BLEND,
+        GL_CULL_FACE,
+        GL_SCISSOR_TEST,
+        GL_STENCIL_TEST,
+    };
+
+    struct BufferRange {
+        unsigned int buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    // Tri-state for capabilities and the depth mask.
+    enum class Toggle : std::uint8_t {
+        UNKNOWN,
+        OFF,
+        ON
+    };
+
+    Counters _counters;
+
+    unsigned int program;
+    unsigned int vertex_array;
+    std::array<unsigned int, buffer_targets.size()> buffers;
+    std::array<BufferRange, max_indexed_buffer_bindings> uniform_buffers;
+    std::array<BufferRange, max_indexed_buffer_bindings> storage_buffers;
+    unsigned int active_texture_unit;
+    std::array<std::array<unsigned int, texture_targets.size()>, max_texture_units> textures;
+    std::array<unsigned int, max_texture_units> samplers;
+
+    std::array<Toggle, capabilities.size()> enabled;
+    std::array<GLenum, 2> blend_factors;
+    GLenum _depth_func;
+    Toggle _depth_mask;
+    std::array<int, 4> _viewport;
+
+    // Counts the call and returns whether it has to be issued.
+    bool changes(const bool changed);
+    void activate_texture_unit(const unsigned int unit);
+};
+
+// State of the GL context current on the calling thread.
+GlState& gl_state();
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "Frustum.hpp"
+#include "MeshPool.hpp"
+#include "Shader.hpp"
+
+// Frustum culling in a compute shader. The objects are uploaded once, every cull
+// appends a draw command and a model matrix per visible object to GPU buffers
+// and the draw count is read by the GPU too, so nothing is read back.
+class GpuCulling {
+public:
+    // Shader storage bindings of the culling shader. Visible models are indexed by
+    // gl_DrawID, the vertex shader reads them at the same binding.
+    static constexpr unsigned int visible_model_binding { 0 };
+    static constexpr unsigned int object_binding { 1 };
+    static constexpr unsigned int command_binding { 2 };
+    static constexpr unsigned int draw_count_binding { 3 };
+
+    // local_size_x of the culling shader
+    static constexpr unsigned int workgroup_size { 64 };
+
+    // std430 layout of the culling shader's Object
+    struct Object {
+        // Bounding sphere center and radius
+        glm::vec4 sphere;
+        std::uint32_t index_count;
+        std::uint32_t first_index;
+        std::int32_t base_vertex;
+        std::uint32_t padding;
+        glm::mat4 model;
+    };
+
+    // Must be created on the thread owning the GL context. The program is built
+    // from the culling shader and may still be deferred, it has to be finished
+    // before the first cull.
+    GpuCulling(Shader& program, const std::span<const Object> objects);
+
+    GpuCulling(const GpuCulling&) = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+
+    ~GpuCulling();
+
+    static Object make_object(
+        const MeshPool::Range& range,
+        const glm::mat4& model,
+        const float radius);
+
+    void cull(const Frustum& frustum);
+
+    // Draws the objects that passed the last cull with the program in use.
+    void draw(const MeshPool& mesh_pool) const;
+
+private:
+    Shader& program;
+    Shader::Uniform<glm::vec4> planes_uniform;
+    Shader::Uniform<int> object_count_uniform;
+
+    std::size_t object_count;
+    unsigned int object_buffer;
+    unsigned int command_buffer;
+    unsigned int visible_model_buffer;
+    unsigned int draw_count_buffer;
+};
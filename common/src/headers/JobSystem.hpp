@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs jobs on one worker thread per core but one, the threads that submit jobs
+// help while they wait for them. Each worker pushes and pops the jobs it submits
+// at the bottom of its own Chase-Lev deque and idle workers steal from the top of
+// the others. Jobs submitted from threads outside the pool go through a shared
+// queue. Background jobs have a queue of their own that only idle workers take
+// from.
+class JobSystem {
+public:
+    using Function = std::move_only_function<void()>;
+
+    // Counts the unfinished jobs submitted with it. Jobs submitted after it run
+    // once it drops to zero. Has to outlive its jobs.
+    class Counter {
+    public:
+        Counter() = default;
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        bool done() const;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<std::uint32_t> pending { 0 };
+        std::mutex continuations_mutex;
+        std::vector<Function> continuations;
+    };
+
+    explicit JobSystem(unsigned int worker_count = default_worker_count());
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Waits for the submitted jobs.
+    ~JobSystem();
+
+    unsigned int worker_count() const;
+
+    void submit(Function function, Counter* counter = nullptr);
+    // Submits function once dependency has dropped to zero, right away if it
+    // already has.
+    void submit_after(Counter& dependency, Function function, Counter* counter = nullptr);
+    // For long jobs nothing per frame waits on, e.g. file decodes. They run once
+    // a worker finds no other job, and wait() never runs them.
+    void submit_background(Function function, Counter* counter = nullptr);
+
+    // Runs other queued jobs until counter drops to zero, and sleeps until it does
+    // once there are none. Jobs must not wait for jobs that block on something
+    // outside the job system.
+    void wait(const Counter& counter);
+
+    // Calls function(begin, end) over [0, count) in chunks of at most grain_size
+    // and waits for all of them. Small ranges run on the calling thread.
+    template <typename F>
+    void parallel_for(const std::size_t count, const std::size_t grain_size, F&& function);
+
+    static unsigned int default_worker_count();
+
+private:
+    struct Job {
+        Function function;
+        Counter* counter;
+    };
+
+    // Chase-Lev deque of fixed capacity. Only the owner pushes and pops, any
+    // thread steals.
+    class WorkDeque {
+    public:
+        static constexpr std::int64_t capacity { 4096 };
+
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        alignas(64) std::atomic<std::int64_t> top { 0 };
+        alignas(64) std::atomic<std::int64_t> bottom { 0 };
+        std::array<std::atomic<Job*>, capacity> jobs {};
+    };
+
+    std::unique_ptr<WorkDeque[]> deques;
+    unsigned int _worker_count;
+
+    // Guards both queues
+    std::mutex shared_mutex;
+    std::deque<Job*> shared_jobs;
+    std::deque<Job*> background_jobs;
+
+    // Bumped whenever a job is queued so sleeping workers recheck.
+    std::atomic<std::uint32_t> work_epoch;
+    std::atomic<bool> stopping;
+
+    std::vector<std::jthread> workers;
+
+    void enqueue(Job* job);
+    Job* find_job();
+    Job* find_background_job();
+    void run(Job* job);
+    void work(const unsigned int worker);
+};
+
+// Shared by every subsystem so they do not each start threads of their own.
+JobSystem& job_system();
+
+template <typename F>
+void JobSystem::parallel_for(const std::size_t count, const std::size_t grain_size, F&& function) {
+    const std::size_t grain { std::max(grain_size, std::size_t { 1 }) };
+    if (count <= grain) {
+        if (count > 0) {
+            function(std::size_t { 0 }, count);
+        }
+        return;
+    }
+
+    Counter counter {};
+    for (std::size_t begin { grain }; begin < count; begin += grain) {
+        const std::size_t end { std::min(begin + grain, count) };
+        this->submit([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+    // The first chunk runs here instead of waiting idle.
+    function(std::size_t { 0 }, grain);
+    this->wait(counter);
+}
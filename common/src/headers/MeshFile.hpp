@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "glad/glad.h"
+
+#include "mesh.hpp"
+
+// Binary mesh container, in host byte order:
+//   MeshFileHeader
+//   MeshFileAttribute[attribute_count]
+//   vertex blob at vertex_offset, index blob at index_offset
+// Blobs are aligned to mesh_file_alignment so they can be handed to GL straight
+// from the mapped file.
+static constexpr std::uint32_t mesh_file_magic { 0x4853454D }; // "MESH"
+static constexpr std::uint32_t mesh_file_version { 1 };
+static constexpr std::size_t mesh_file_alignment { 64 };
+
+struct MeshFileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t attribute_count;
+    // Bytes per vertex
+    std::uint32_t vertex_stride;
+    std::uint64_t vertex_count;
+    std::uint64_t index_count;
+    std::uint32_t index_type;
+    std::uint32_t padding;
+    std::uint64_t vertex_offset;
+    std::uint64_t vertex_size;
+    std::uint64_t index_offset;
+    std::uint64_t index_size;
+    // Axis aligned bounds of the positions
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+struct MeshFileAttribute {
+    std::uint32_t component_count;
+    // GL_FLOAT, meshes only have float attributes so far.
+    std::uint32_t component_type;
+    // Bytes from the start of the vertex
+    std::uint32_t offset;
+    std::uint32_t padding;
+};
+
+// Writes the mesh with attribute i having attribute_sizes[i] floats, the first
+// attribute being the position. Returns false if the file cannot be written.
+bool write_mesh_file(
+    const std::filesystem::path& path,
+    const Mesh& mesh,
+    const std::span<const int> attribute_sizes);
+
+// Read only mapping of a mesh file. Quits if the file cannot be mapped or is not
+// a valid mesh file, the counts, sizes and attributes of the header are all
+// checked against each other and the file size. Nothing is parsed or copied,
+// the spans point into the mapped pages.
+class MappedMesh {
+public:
+    explicit MappedMesh(const std::filesystem::path& path);
+
+    MappedMesh(const MappedMesh&) = delete;
+    MappedMesh& operator=(const MappedMesh&) = delete;
+
+    ~MappedMesh();
+
+    const MeshFileHeader& header() const;
+    std::span<const MeshFileAttribute> attributes() const;
+    std::span<const std::byte> vertices() const;
+    std::span<const std::byte> indices() const;
+
+private:
+    const std::byte* mapped;
+    std::size_t size;
+};
+
+// Vertex array with immutable vertex and index buffers created from a mapped
+// mesh, attribute i is bound to location i and the vertices to binding 0. Quits
+// if the mesh exceeds the attribute limits of the driver. Must be created on the
+// thread owning the GL context.
+class MeshBuffers {
+public:
+    explicit MeshBuffers(const MappedMesh& mesh);
+
+    MeshBuffers(const MeshBuffers&) = delete;
+    MeshBuffers& operator=(const MeshBuffers&) = delete;
+
+    ~MeshBuffers();
+
+    unsigned int vertex_array() const;
+    GLsizei index_count() const;
+    GLenum index_type() const;
+
+private:
+    unsigned int _vertex_array;
+    unsigned int vertex_buffer;
+    unsigned int index_buffer;
+    GLsizei _index_count;
+    GLenum _index_type;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "glad/glad.h"
+
+#include "mesh.hpp"
+
+// Vertices and indices of many meshes in one vertex buffer and one index buffer
+// sharing a single vertex array, so all of them can be drawn by one
+// glMultiDrawElementsIndirect call.
+class MeshPool {
+public:
+    // Indices of every mesh are widened to this type.
+    static constexpr GLenum index_type { GL_UNSIGNED_INT };
+
+    struct Range {
+        std::uint32_t first_index;
+        std::uint32_t index_count;
+        std::int32_t base_vertex;
+    };
+
+    // Layout read by glMultiDrawElementsIndirect.
+    struct DrawElementsIndirectCommand {
+        std::uint32_t count;
+        std::uint32_t instance_count;
+        std::uint32_t first_index;
+        std::int32_t base_vertex;
+        std::uint32_t base_instance;
+    };
+
+    // Vertices are interleaved floats, attribute i has attribute_sizes[i]
+    // components and is bound to location i. Must be created on the thread owning
+    // the GL context.
+    MeshPool(
+        const std::span<const int> attribute_sizes,
+        const std::size_t max_vertices,
+        const std::size_t max_indices);
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    ~MeshPool();
+
+    unsigned int vertex_array() const;
+
+    // Copies the mesh into the pool, quits if it does not fit or its vertex layout
+    // differs from the pool's.
+    Range add(const Mesh& mesh);
+
+    // Issues as many commands as the count at count_offset in count_buffer says,
+    // at most max_draw_count.
+    void multi_draw_count(
+        const unsigned int command_buffer,
+        const std::size_t offset,
+        const unsigned int count_buffer,
+        const std::size_t count_offset,
+        const GLsizei max_draw_count) const;
+
+private:
+    unsigned int _vertex_array;
+    unsigned int vertex_buffer;
+    unsigned int index_buffer;
+
+    std::size_t floats_per_vertex;
+    std::size_t max_vertices;
+    std::size_t max_indices;
+    std::size_t vertex_count;
+    std::size_t index_count;
+};
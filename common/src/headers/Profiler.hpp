@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Zone names must be string literals, only the pointer is recorded.
+#define PROFILE_CPU_ZONE(name) CpuZone PROFILE_CONCAT(cpu_zone_, __LINE__) { name }
+#define PROFILE_GPU_ZONE(profiler, name) GpuZone PROFILE_CONCAT(gpu_zone_, __LINE__) { profiler, name }
+
+struct ProfileEvent {
+    const char* name;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+    std::uint32_t thread_id;
+};
+
+// Collects CPU zones from every thread and GPU zones from the thread owning the GL
+// context, and writes them out as Chrome trace events (chrome://tracing, Perfetto).
+class Profiler {
+public:
+    // Must be created on the thread owning the GL context unless gpu_zones is false,
+    // GPU zones are then ignored and no GL call is made.
+    explicit Profiler(const bool enabled, const bool gpu_zones = true);
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ~Profiler();
+
+    static bool enabled();
+    static std::uint64_t now_ns();
+    // Called by CpuZone, safe from any thread.
+    static void record_cpu_zone(const char* name, const std::uint64_t begin_ns, const std::uint64_t end_ns);
+
+    std::size_t begin_gpu_zone(const char* name);
+    void end_gpu_zone(const std::size_t zone);
+
+    // Collects the CPU zones recorded since the last call and the GPU zones of the
+    // oldest frame in flight if its queries are done. Never waits for the GPU.
+    void end_frame();
+
+    void write_chrome_trace(const std::filesystem::path& path) const;
+
+private:
+    // A frame's queries are read back query_pool_count - 1 frames later, results
+    // that are still not available then are dropped instead of waited on.
+    static constexpr std::size_t query_pool_count { 3 };
+    static constexpr std::size_t max_gpu_zones_per_frame { 64 };
+
+    struct QueryPool {
+        std::array<unsigned int, max_gpu_zones_per_frame * 2> queries;
+        std::array<const char*, max_gpu_zones_per_frame> names;
+        std::size_t zone_count;
+    };
+
+    bool gpu_zones;
+    std::array<QueryPool, query_pool_count> query_pools;
+    std::size_t query_pool_index;
+    std::int64_t gpu_to_cpu_offset_ns;
+    std::size_t dropped_gpu_frames;
+
+    std::vector<ProfileEvent> events;
+
+    void resolve_query_pool(QueryPool& pool);
+};
+
+class CpuZone {
+public:
+    explicit CpuZone(const char* name);
+    ~CpuZone();
+
+private:
+    const char* name;
+    std::uint64_t begin_ns;
+};
+
+class GpuZone {
+public:
+    GpuZone(Profiler& profiler, const char* name);
+    ~GpuZone();
+
+private:
+    Profiler& profiler;
+    std::size_t zone;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// On-disk cache of linked program binaries. Must be created after the GL context,
+// since keys include the vendor, renderer, version and supported binary formats.
+class ProgramCache {
+public:
+    explicit ProgramCache(std::filesystem::path directory);
+
+    bool enabled() const;
+
+    std::uint64_t make_key(
+        const std::string_view& vertex_code,
+        const std::string_view& fragment_code) const;
+
+    // Returns false when there is no entry or the driver rejects the binary,
+    // in which case the program has to be built from source.
+    bool load(const unsigned int program, const std::uint64_t key) const;
+
+    void store(const unsigned int program, const std::uint64_t key) const;
+
+private:
+    std::filesystem::path directory;
+    std::string context_signature;
+    bool _enabled;
+
+    std::filesystem::path entry_path(const std::uint64_t key) const;
+};
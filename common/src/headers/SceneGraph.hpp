@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "TransformStore.hpp"
+
+// Parent and child transforms stored breadth first: the nodes of each depth level
+// are kept in flat arrays, with the local transforms as a TransformStore. update()
+// walks the levels from the roots down, one level at a time in parallel, and only
+// visits the chunks of a level holding changed nodes or children of nodes whose
+// world matrix changed, so a static scene costs a check per chunk. Nodes are
+// never removed.
+class SceneGraph {
+public:
+    struct Node {
+        std::uint32_t level;
+        std::uint32_t index;
+    };
+
+    Node add_root(
+        const glm::vec3& position,
+        const glm::quat& rotation = glm::quat { 1.0f, 0.0f, 0.0f, 0.0f },
+        const glm::vec3& scale = glm::vec3 { 1.0f });
+
+    Node add_child(
+        const Node parent,
+        const glm::vec3& position,
+        const glm::quat& rotation = glm::quat { 1.0f, 0.0f, 0.0f, 0.0f },
+        const glm::vec3& scale = glm::vec3 { 1.0f });
+
+    void set_position(const Node node, const glm::vec3& position);
+    void set_rotation(const Node node, const glm::quat& rotation);
+    void set_scale(const Node node, const glm::vec3& scale);
+
+    void update();
+
+    // Valid after update()
+    const glm::mat4& world_matrix(const Node node) const;
+    // The world matrices of a level in node index order, ready to upload.
+    std::span<const glm::mat4> world_matrices(const std::size_t level) const;
+
+    std::size_t level_count() const;
+    std::size_t node_count(const std::size_t level) const;
+
+private:
+    // Nodes [begin, end), empty when begin >= end
+    struct Range {
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    struct Level {
+        TransformStore local;
+        // Index of the parent in the level above, unused for the roots
+        std::vector<std::uint32_t> parents;
+        std::vector<glm::mat4> local_matrices;
+        std::vector<glm::mat4> world_matrices;
+        // Bytes rather than bits so jobs can write neighbouring flags.
+        std::vector<std::uint8_t> local_dirty;
+        // The update() that last changed the world matrix of each node
+        std::vector<std::uint32_t> world_changed;
+
+        // Per chunk of nodes: set if one of them has a dirty local transform,
+        // and the parents of its nodes.
+        std::vector<std::uint8_t> dirty_chunks;
+        std::vector<Range> chunk_parents;
+        std::size_t dirty_chunk_count { 0 };
+        // Covers the nodes whose world matrix changed in the last update().
+        Range changed { 0, 0 };
+    };
+
+    std::vector<Level> levels;
+    std::uint32_t update_serial { 0 };
+    // Scratch space of update(), kept so it does not allocate.
+    std::vector<std::uint32_t> update_chunks;
+    std::vector<Range> chunk_changes;
+
+    Node add_node(
+        const std::size_t level,
+        const std::uint32_t parent,
+        const glm::vec3& position,
+        const glm::quat& rotation,
+        const glm::vec3& scale);
+    void mark_dirty(const Node node);
+    // Returns the nodes of the chunk whose world matrix changed.
+    Range update_chunk(const std::size_t level, const std::size_t chunk);
+};
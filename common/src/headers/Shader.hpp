@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "glad/glad.h"
+
+#include "ProgramCache.hpp"
+
+class Shader {
+    public:
+        // Handle of an active uniform resolved once with get_uniform. Stays valid
+        // across reloads, its location is looked up again after each one.
+        template <typename T>
+        struct Uniform {
+            int handle { -1 };
+        };
+
+        // Constructor tag for a build that is only started, see finish_builds.
+        struct Deferred {};
+        static constexpr Deferred deferred {};
+
+        enum class ReloadStatus {
+            IDLE,
+            PENDING,
+            RELOADED,
+            FAILED
+        };
+
+        Shader(
+            const char* vertex_path,
+            const char* fragment_path,
+            const ProgramCache* program_cache = nullptr);
+
+        // Compute program
+        explicit Shader(const char* compute_path, const ProgramCache* program_cache = nullptr);
+
+        // Defines are given as NAME or NAME=VALUE, see preprocess_shader.
+        Shader(
+            const char* vertex_path,
+            const char* fragment_path,
+            const ProgramCache* program_cache,
+            Deferred,
+            const std::span<const std::string_view> defines = {});
+
+        Shader(
+            const char* compute_path,
+            const ProgramCache* program_cache,
+            Deferred,
+            const std::span<const std::string_view> defines = {});
+
+        // Waits for deferred builds, finishing each program as soon as the driver
+        // is done with it, so all of them compile in parallel when the driver
+        // supports GL_KHR_parallel_shader_compile. Quits if one fails. Uniform
+        // handles can be taken before, the program id is 0 until then.
+        static void finish_builds(const std::span<Shader* const> shaders);
+
+        // Every program finishing its build or reload afterwards gets the uniform
+        // block with this name bound to binding, programs without the block are
+        // left alone.
+        static void set_uniform_block_binding(
+            const std::string_view& block_name,
+            const unsigned int binding);
+
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+
+        unsigned int id() const;
+
+        // Stage files and the files they include
+        std::vector<std::filesystem::path> source_paths() const;
+
+        template <typename T>
+        Uniform<T> get_uniform(const std::string_view& name) {
+            return Uniform<T> { this->add_uniform_handle(name) };
+        }
+
+        // Starts rebuilding the program from its source files, replacing a reload
+        // that is still pending. The current program stays in use meanwhile.
+        void reload();
+
+        // Finishes a started reload once it is done. On success the new program
+        // replaces the old one, on failure the errors are logged and the old one
+        // is kept.
+        ReloadStatus poll_reload();
+
+        void use() const;
+
+        // Setters write to the program directly, it does not have to be in use.
+        void set_bool(const std::string_view &name, const bool value) const;
+        void set_int(const std::string_view &name, const int value) const;
+        void set_float(const std::string_view &name, const float value) const;
+        void set_vec3(const std::string_view &name, const glm::vec3& value) const;
+        void set_mat4(const std::string_view& name, const glm::mat4& value) const;
+
+        void set_bool(const Uniform<bool> uniform, const bool value) const;
+        void set_int(const Uniform<int> uniform, const int value) const;
+        void set_float(const Uniform<float> uniform, const float value) const;
+        void set_vec3(const Uniform<glm::vec3> uniform, const glm::vec3& value) const;
+        void set_vec4(const Uniform<glm::vec4> uniform, const std::span<const glm::vec4> values) const;
+        void set_mat4(const Uniform<glm::mat4> uniform, const glm::mat4& value) const;
+
+    private:
+        struct Stage {
+            GLenum type;
+            const char* name;
+            std::string code;
+        };
+
+        struct StageSource {
+            GLenum type;
+            const char* name;
+            std::filesystem::path path;
+        };
+
+        // Program being compiled and linked, shaders is empty when it came from
+        // the program cache.
+        struct PendingProgram {
+            unsigned int program;
+            std::vector<unsigned int> shaders;
+            std::uint64_t cache_key;
+        };
+
+        struct UniformEntry {
+            std::uint64_t hash;
+            std::string name;
+            int location { -1 };
+        };
+
+        unsigned int _id;
+        const ProgramCache* program_cache;
+        std::vector<StageSource> sources;
+        std::vector<std::string> defines;
+        // Files read by the last build
+        std::vector<std::filesystem::path> dependencies;
+        std::optional<PendingProgram> pending;
+
+        // Open addressing table with a power of two size, filled after link.
+        std::vector<UniformEntry> uniforms;
+        // Indexed by Uniform::handle
+        std::vector<std::string> handle_names;
+        std::vector<int> handle_locations;
+
+        void start_from_sources(
+            std::vector<StageSource> sources,
+            const std::span<const std::string_view> defines);
+        void finish_initial_build();
+        bool read_stages(std::vector<Stage>& stages);
+        PendingProgram start_build(const std::span<const Stage> stages) const;
+        // Never blocks when parallel shader compile is supported.
+        bool build_complete(const PendingProgram& pending) const;
+        // Returns 0 if the program failed to build, after deleting it.
+        unsigned int finish_build(PendingProgram& pending) const;
+        int add_uniform_handle(const std::string_view& name);
+        void bind_uniform_blocks() const;
+        void reflect_uniforms();
+        int find_uniform_location(const std::string_view& name) const;
+        int require_uniform_location(const std::string_view& name) const;
+};
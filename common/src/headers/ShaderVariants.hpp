@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ProgramCache.hpp"
+#include "Shader.hpp"
+
+// Shares one program between every request for the same shader permutation. A
+// permutation is keyed by the hash of its preprocessed sources, which contain
+// the defines, so requests naming different files with the same contents share
+// a program too.
+class ShaderVariants {
+public:
+    explicit ShaderVariants(const ProgramCache* program_cache = nullptr);
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // New programs are deferred, call finish_builds before using them. The
+    // reference stays valid as long as the ShaderVariants.
+    Shader& get(
+        const char* vertex_path,
+        const char* fragment_path,
+        const std::span<const std::string_view> defines = {});
+
+    Shader& get(
+        const char* compute_path,
+        const std::span<const std::string_view> defines = {});
+
+    // Finishes the programs created since the last call, in parallel where the
+    // driver allows.
+    void finish_builds();
+
+    // Distinct programs
+    std::size_t size() const;
+
+private:
+    const ProgramCache* program_cache;
+    std::unordered_map<std::uint64_t, std::unique_ptr<Shader>> shaders;
+    std::vector<Shader*> building;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.hpp"
+
+// Watches the source files of shaders with inotify and reloads a shader on the
+// frame after one of its files changed. Directories are watched rather than
+// files, since editors often save by replacing the file.
+class ShaderWatcher {
+public:
+    ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    ~ShaderWatcher();
+
+    // The shader must outlive the watcher.
+    void watch(Shader& shader);
+
+    // Never blocks. Starts reloading the shaders whose sources changed since the
+    // last call and finishes reloads started before.
+    void poll();
+
+private:
+    struct WatchedShader {
+        Shader* shader;
+        std::vector<std::filesystem::path> paths;
+    };
+
+    // -1 if inotify is unavailable, shaders are then never reloaded.
+    int fd;
+    // Watch descriptor to directory
+    std::unordered_map<int, std::filesystem::path> directories;
+    std::vector<WatchedShader> shaders;
+
+    // Adds watches for the directories of the shader's sources that are not
+    // watched yet. Returns the canonical source paths.
+    std::vector<std::filesystem::path> watch_sources(const Shader& shader);
+};
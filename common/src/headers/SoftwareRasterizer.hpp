@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
+
+// Renders meshes on the CPU into an RGBA8 color buffer with a depth buffer, for
+// machines without a GPU or GL driver. Draws are transformed, clipped against the
+// near plane and binned into tiles as they are submitted, finish() rasterizes the
+// tiles in parallel on the job system.
+//
+// Follows GL conventions so results can be compared with a GL render: rows start
+// at the bottom, depth is tested with GL_LESS against a buffer cleared to 1 and
+// both windings are drawn.
+class SoftwareRasterizer {
+public:
+    static constexpr int tile_size { 64 };
+    // Side of the blocks whose farthest depth is kept to reject hidden triangles.
+    static constexpr int depth_block_size { 8 };
+
+    // RGB8 image, rows from the bottom like a GL texture. Sampled bilinearly with
+    // GL_REPEAT wrapping.
+    struct Texture {
+        int width;
+        int height;
+        std::vector<unsigned char> rgb;
+    };
+
+    // Decodes an image file flipped like the GL chapters upload it, alpha is
+    // dropped. Empty when the file cannot be decoded.
+    static std::optional<Texture> load_texture(const std::filesystem::path& img_path);
+
+    // Without textures the fragment color is color, matching
+    // light_color * object_color in the colors chapter's shader.frag. With them it
+    // is mix(texture(texture0, uv), texture(texture1, uv), texture_mix) like the
+    // camera chapter's shader.frag, texture1 may be null to sample texture0 only.
+    struct Material {
+        glm::vec3 color;
+        const Texture* texture0;
+        const Texture* texture1;
+        float texture_mix;
+    };
+
+    // The position is the first three floats of a vertex, the texture
+    // coordinates the next two for textured materials. The mesh and textures
+    // have to outlive finish().
+    struct Draw {
+        const Mesh* mesh;
+        glm::mat4 model;
+        Material material;
+    };
+
+    SoftwareRasterizer(const int width, const int height);
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    int width() const;
+    int height() const;
+
+    // Clears color and depth, the frame starts with no draws.
+    void clear(const glm::vec3& color);
+
+    void set_view_projection(const glm::mat4& view_projection);
+
+    void draw(const Draw& draw);
+
+    // Rasterizes the draws submitted since clear.
+    void finish();
+
+    // RGBA8 with red in the lowest byte.
+    std::uint32_t pixel(const int x, const int y) const;
+
+    // Binary PPM, top row first.
+    bool write_ppm(const std::filesystem::path& path) const;
+
+private:
+    // Screen space triangle. Every attribute is a plane a * x + b * y + c over
+    // pixel coordinates, the edges are normalized so they are the barycentric
+    // coordinates of the opposite vertex.
+    struct Triangle {
+        glm::vec3 edge_a;
+        glm::vec3 edge_b;
+        glm::vec3 edge_c;
+        glm::vec3 depth;
+        glm::vec3 inverse_w;
+        glm::vec3 u_over_w;
+        glm::vec3 v_over_w;
+        float min_depth;
+        std::uint32_t material;
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+    };
+
+    int _width;
+    int _height;
+    // Buffers are padded to whole depth blocks.
+    int stride;
+    int tiles_x;
+    int tiles_y;
+    int blocks_x;
+    bool use_avx2;
+
+    std::vector<std::uint32_t> color;
+    std::vector<float> depth;
+    // Farthest depth of each depth block
+    std::vector<float> block_max_depth;
+
+    glm::mat4 view_projection;
+    // Scratch space for the vertices of a draw
+    std::vector<glm::vec4> clip_positions;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<Material> materials;
+    std::vector<Triangle> triangles;
+    // Triangle indices per tile, in submission order
+    std::vector<std::vector<std::uint32_t>> bins;
+
+    void add_triangle(const glm::vec4* clip, const glm::vec2* uv, const std::uint32_t material);
+    void bin_triangle(const glm::vec4* clip, const glm::vec2* uv, const std::uint32_t material);
+    void rasterize_tile(const std::uint32_t tile);
+    void rasterize_block(const Triangle& triangle, const int block_x, const int block_y);
+    // Writes the color of the pixels set in mask, from x on row y.
+    void shade_row(const Triangle& triangle, const int x, const int y, unsigned int mask);
+};
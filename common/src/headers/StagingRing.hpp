@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+#include "glad/glad.h"
+
+// Persistently mapped GL_PIXEL_UNPACK_BUFFER used as a ring of staging regions.
+// Any thread may allocate and write a region, the render thread submits the
+// upload reading from it and the region is recycled once its fence has signaled.
+class StagingRing {
+public:
+    struct Region {
+        std::size_t offset;
+        std::size_t size;
+        unsigned char* data;
+    };
+
+    // Must be created on the thread owning the GL context.
+    explicit StagingRing(const std::size_t capacity);
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    ~StagingRing();
+
+    unsigned int buffer() const;
+    std::size_t capacity() const;
+
+    // Never blocks. Returns nothing when there is no space until more regions are
+    // retired, or when the request can never fit.
+    std::optional<Region> try_allocate(const std::size_t size);
+
+    // Render thread only. Fences the region after the commands reading from it.
+    void submit(const Region& region);
+
+    // Render thread only. Recycles regions whose uploads have completed.
+    void retire();
+
+private:
+    struct Allocation {
+        std::size_t offset;
+        std::size_t size;
+        GLsync fence;
+    };
+
+    static constexpr std::size_t alignment { 64 };
+
+    unsigned int _buffer;
+    std::size_t _capacity;
+    unsigned char* mapped;
+
+    std::mutex mutex;
+    // In allocation order, only the front can be recycled.
+    std::deque<Allocation> allocations;
+
+    std::optional<std::size_t> find_space(const std::size_t size) const;
+    // Called with the mutex held.
+    Region claim(const std::size_t offset, const std::size_t size);
+};
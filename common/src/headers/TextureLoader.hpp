@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "StagingRing.hpp"
+
+// Decodes images as background jobs on the shared job system. load() returns a
+// texture name right away which samples a placeholder until upload_pending() has
+// uploaded the image.
+// Decoded pixels are staged in a persistently mapped unpack buffer so uploads do
+// not copy on the render thread, images that do not fit in it are uploaded from
+// memory.
+class TextureLoader {
+public:
+    static constexpr std::size_t default_staging_size { 64 * 1024 * 1024 };
+    // Textures are bound here while they are filled and left bound afterwards.
+    static constexpr unsigned int upload_texture_unit { 0 };
+
+    explicit TextureLoader(const std::size_t staging_size = default_staging_size);
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Waits for the decodes in flight.
+    ~TextureLoader();
+
+    unsigned int load(
+        const std::filesystem::path& img_path,
+        const int gl_pixel_data_format);
+
+    // Uploads decoded images until the byte budget is spent. At least one image is
+    // uploaded per call so images bigger than the budget still get through.
+    // Must be called on the thread owning the GL context.
+    void upload_pending(const std::size_t byte_budget);
+
+    std::size_t pending_count() const;
+
+private:
+    struct PixelsDeleter {
+        void operator()(unsigned char* pixels) const;
+    };
+
+    struct Request {
+        unsigned int texture;
+        std::filesystem::path img_path;
+        int gl_pixel_data_format;
+    };
+
+    struct DecodedImage {
+        Request request;
+        int width;
+        int height;
+        int channels;
+        // Exactly one of these holds the pixels after a successful decode.
+        std::unique_ptr<unsigned char, PixelsDeleter> pixels;
+        std::optional<StagingRing::Region> staging;
+    };
+
+    StagingRing staging;
+
+    std::mutex decoded_mutex;
+    std::vector<DecodedImage> decoded;
+
+    // Only touched on the render thread.
+    std::size_t in_flight;
+
+    // Decodes that have not finished
+    JobSystem::Counter decodes;
+
+    void decode(Request request);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Translation, rotation and scale of many objects kept as structure of arrays so
+// model matrices are built for several objects per instruction. Rotations must be
+// unit quaternions.
+class TransformStore {
+public:
+    using Index = std::uint32_t;
+
+    void reserve(const std::size_t count);
+    std::size_t size() const;
+
+    Index add(
+        const glm::vec3& position,
+        const glm::quat& rotation = glm::quat { 1.0f, 0.0f, 0.0f, 0.0f },
+        const glm::vec3& scale = glm::vec3 { 1.0f });
+
+    glm::vec3 position(const Index index) const;
+    glm::quat rotation(const Index index) const;
+    glm::vec3 scale(const Index index) const;
+
+    void set_position(const Index index, const glm::vec3& position);
+    void set_rotation(const Index index, const glm::quat& rotation);
+    void set_scale(const Index index, const glm::vec3& scale);
+
+    // translate(position) * mat4_cast(rotation) * scale(scale) of count objects
+    // starting at first. Matrix i is written stride bytes after matrix i - 1 so
+    // they can go straight into a mapped buffer of bigger structs. Large counts
+    // are split across the job system.
+    void write_model_matrices(
+        const Index first,
+        const std::size_t count,
+        glm::mat4* out,
+        const std::size_t stride = sizeof(glm::mat4)) const;
+
+    // Every object, out must hold size() matrices.
+    void write_model_matrices(std::span<glm::mat4> out) const;
+
+private:
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_z;
+    std::vector<float> rotation_x;
+    std::vector<float> rotation_y;
+    std::vector<float> rotation_z;
+    std::vector<float> rotation_w;
+    std::vector<float> scale_x;
+    std::vector<float> scale_y;
+    std::vector<float> scale_z;
+
+    void write_range(
+        const std::size_t begin,
+        const std::size_t end,
+        std::byte* out,
+        const std::size_t stride) const;
+};
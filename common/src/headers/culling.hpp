@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Frustum.hpp"
+
+// Bounds are kept as structure of arrays so several objects are tested per instruction.
+
+struct BoundingSpheres {
+    const float* center_x;
+    const float* center_y;
+    const float* center_z;
+    const float* radius;
+    std::size_t count;
+};
+
+struct BoundingBoxes {
+    const float* center_x;
+    const float* center_y;
+    const float* center_z;
+    const float* extent_x;
+    const float* extent_y;
+    const float* extent_z;
+    std::size_t count;
+};
+
+// Replace the contents of visible with the indices of the objects that are at
+// least partially inside the frustum, in ascending order. Large counts are split
+// across the job system.
+void cull_spheres(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    std::vector<std::uint32_t>& visible);
+
+void cull_boxes(
+    const Frustum& frustum,
+    const BoundingBoxes& boxes,
+    std::vector<std::uint32_t>& visible);
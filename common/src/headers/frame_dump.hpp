@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "SoftwareRasterizer.hpp"
+
+// Prints the count, mean, median, min and max of frames rendered without a
+// window, times in milliseconds.
+void print_frame_times(std::vector<float> frame_times);
+
+// Writes the last frame of the software backend as a binary PPM, quits if the
+// file cannot be written.
+void dump_frame(const SoftwareRasterizer& rasterizer, const std::filesystem::path& image_path);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Uniform block shared by every program that includes camera.glsl. It is
+// written once per frame and bound at frame_uniform_binding, programs get the
+// block bound to it after link, see Shader::set_uniform_block_binding.
+inline constexpr const char* frame_uniform_block { "Frame" };
+inline constexpr unsigned int frame_uniform_binding { 0 };
+
+// std140 layout of the Frame block
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    // Width and height in pixels, then their reciprocals
+    glm::vec4 viewport;
+    // Seconds since start
+    float time;
+    float padding[3];
+};
+
+static_assert(sizeof(FrameUniforms) == 160, "FrameUniforms must match the std140 Frame block.");
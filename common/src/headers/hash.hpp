@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+inline constexpr std::uint64_t fnv1a_offset_basis { 14695981039346656037ull };
+
+// FNV-1a, pass a previous result as the basis to hash several strings in sequence.
+constexpr std::uint64_t fnv1a(
+    const std::string_view& data,
+    const std::uint64_t basis = fnv1a_offset_basis) {
+
+    std::uint64_t hash { basis };
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
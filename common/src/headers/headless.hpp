@@ -0,0 +1,6 @@
+#pragma once
+
+// Surfaceless EGL context rendering into an offscreen framebuffer, so the render
+// loop can run without a display server or GPU (e.g. on Mesa llvmpipe).
+void create_headless_context(const int width, const int height);
+void destroy_headless_context();
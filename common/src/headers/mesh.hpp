@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "glad/glad.h"
+
+// Indexed geometry with interleaved float vertices.
+struct Mesh {
+    std::vector<float> vertices;
+    std::size_t floats_per_vertex;
+    std::size_t vertex_count;
+    // Packed indices of index_type, the smallest type that fits vertex_count.
+    std::vector<std::byte> indices;
+    std::size_t index_count;
+    GLenum index_type;
+};
+
+// Builds indexed geometry from a triangle soup of interleaved float vertices.
+// Vertices whose attribute bytes are identical are merged, triangles are
+// reordered for the post-transform vertex cache and vertices are laid out in the
+// order the triangles first reference them.
+Mesh build_mesh(const std::span<const float> triangle_soup, const std::size_t floats_per_vertex);
+
+std::size_t index_type_size(const GLenum index_type);
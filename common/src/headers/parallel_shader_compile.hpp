@@ -0,0 +1,14 @@
+#pragma once
+
+#include "glad/glad.h"
+
+// From GL_KHR_parallel_shader_compile, which the bundled glad does not load.
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+// Looks for GL_KHR_parallel_shader_compile or its ARB twin and lets the driver
+// use as many compiler threads as it wants. Call once after loading GL.
+void load_parallel_shader_compile(GLADloadproc load);
+
+// Whether GL_COMPLETION_STATUS_KHR can be queried, polling it never blocks.
+bool parallel_shader_compile_supported();
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PreprocessedShader {
+    std::string code;
+    // The shader file first, then the included files in the order they were found.
+    std::vector<std::filesystem::path> files;
+};
+
+// Searched for #include "name" after the directory of the including file.
+void add_shader_include_directory(const std::filesystem::path& directory);
+
+// Expands #include "name" directives, each file at most once, and inserts a
+// #define after the #version line for every define given as NAME or NAME=VALUE.
+// #line directives keep compiler messages pointing at the right line, their
+// source string number is the file's index in files. Logs and returns false if a
+// file cannot be read, an include is not found or the shader file has no #version
+// line.
+bool preprocess_shader(
+    const std::filesystem::path& path,
+    const std::span<const std::string_view> defines,
+    PreprocessedShader& shader);
@@ -0,0 +1,97 @@
+#include <format>
+
+#include "glad/glad.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "error_handling.hpp"
+#include "parallel_shader_compile.hpp"
+#include "quit.hpp"
+
+static EGLDisplay display { EGL_NO_DISPLAY };
+static EGLContext context { EGL_NO_CONTEXT };
+
+static unsigned int framebuffer {};
+static unsigned int color_renderbuffer {};
+static unsigned int depth_renderbuffer {};
+
+void create_headless_context(const int width, const int height) {
+    display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) {
+        log_error("Failed to get surfaceless EGL display.");
+        quit(1);
+    }
+
+    EGLint egl_major {};
+    EGLint egl_minor {};
+    if (eglInitialize(display, &egl_major, &egl_minor) != EGL_TRUE) {
+        log_error(std::format("eglInitialize failed. Error code: {:#x}", eglGetError()).c_str());
+        quit(1);
+    }
+
+    if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+        log_error("EGL display does not support desktop OpenGL.");
+        quit(1);
+    }
+
+    // No surface is ever created, so no config is needed either.
+    constexpr EGLint context_attribs[] {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+    if (context == EGL_NO_CONTEXT) {
+        log_error(std::format("Failed to create an OpenGL 4.6 context. Error code: {:#x}. "
+                              "Mesa drivers can be forced with MESA_GL_VERSION_OVERRIDE=4.6.",
+            eglGetError())
+                .c_str());
+        quit(1);
+    }
+
+    if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) != EGL_TRUE) {
+        log_error(std::format("eglMakeCurrent failed. Error code: {:#x}", eglGetError()).c_str());
+        quit(1);
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+        log_error("Failed to init GLAD.");
+        quit(1);
+    }
+    load_parallel_shader_compile((GLADloadproc) eglGetProcAddress);
+
+    // Offscreen framebuffer standing in for the window
+    glGenRenderbuffers(1, &color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depth_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+        color_renderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+        depth_renderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        log_error("Offscreen framebuffer is incomplete.");
+        quit(1);
+    }
+}
+
+void destroy_headless_context() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color_renderbuffer);
+    glDeleteRenderbuffers(1, &depth_renderbuffer);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+}
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include "error_handling.hpp"
+#include "hash.hpp"
+#include "mesh.hpp"
+#include "quit.hpp"
+
+// Vertex cache optimization after Tom Forsyth's "Linear-Speed Vertex Cache
+// Optimisation": triangles are emitted greedily by a score favouring vertices
+// recently used by an emitted triangle and vertices with few triangles left.
+static constexpr std::size_t cache_size { 32 };
+static constexpr float cache_decay_power { 1.5f };
+static constexpr float last_triangle_score { 0.75f };
+static constexpr float valence_boost_scale { 2.0f };
+static constexpr float valence_boost_power { 0.5f };
+
+static constexpr std::uint32_t no_vertex { std::numeric_limits<std::uint32_t>::max() };
+
+static float vertex_score(const int cache_position, const std::uint32_t triangles_left) {
+    if (triangles_left == 0) {
+        return -1.0f;
+    }
+
+    float score { 0.0f };
+    if (cache_position >= 3) {
+        const float scaler { 1.0f / (cache_size - 3) };
+        score = std::pow(1.0f - (cache_position - 3) * scaler, cache_decay_power);
+    } else if (cache_position >= 0) {
+        // The vertices of the last triangle get a fixed score so the next triangle
+        // does not just reuse the most recent edge.
+        score = last_triangle_score;
+    }
+
+    return score + valence_boost_scale * std::pow(triangles_left, -valence_boost_power);
+}
+
+// Merges vertices with identical bytes. Fills vertices with the unique vertices and
+// returns the index of each soup vertex into them.
+static std::vector<std::uint32_t> deduplicate(
+    const std::span<const float> triangle_soup,
+    const std::size_t floats_per_vertex,
+    std::vector<float>& vertices) {
+
+    const std::size_t soup_vertex_count { triangle_soup.size() / floats_per_vertex };
+    const std::size_t vertex_bytes { floats_per_vertex * sizeof(float) };
+
+    // Open addressing on unique vertex indices, load factor at or below one half.
+    const std::size_t table_size { std::bit_ceil(soup_vertex_count * 2 + 1) };
+    const std::size_t mask { table_size - 1 };
+    std::vector<std::uint32_t> table(table_size, no_vertex);
+
+    std::vector<std::uint32_t> remap(soup_vertex_count);
+    vertices.clear();
+    for (std::size_t i { 0 }; i < soup_vertex_count; i++) {
+        const float* vertex { triangle_soup.data() + i * floats_per_vertex };
+        const std::string_view bytes { reinterpret_cast<const char*>(vertex), vertex_bytes };
+
+        std::size_t slot { fnv1a(bytes) & mask };
+        while (table[slot] != no_vertex) {
+            const float* unique { vertices.data() + table[slot] * floats_per_vertex };
+            if (std::memcmp(unique, vertex, vertex_bytes) == 0) {
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        if (table[slot] == no_vertex) {
+            table[slot] = vertices.size() / floats_per_vertex;
+            vertices.insert(vertices.end(), vertex, vertex + floats_per_vertex);
+        }
+        remap[i] = table[slot];
+    }
+
+    return remap;
+}
+
+// Returns the triangles of indices reordered for the post-transform vertex cache.
+static std::vector<std::uint32_t> optimize_vertex_cache(
+    const std::vector<std::uint32_t>& indices,
+    const std::size_t vertex_count) {
+
+    const std::size_t triangle_count { indices.size() / 3 };
+
+    // Triangles using each vertex, as offsets into one array.
+    std::vector<std::uint32_t> triangles_left(vertex_count, 0);
+    for (const std::uint32_t index : indices) {
+        triangles_left[index]++;
+    }
+    std::vector<std::uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (std::size_t vertex { 0 }; vertex < vertex_count; vertex++) {
+        adjacency_offsets[vertex + 1] = adjacency_offsets[vertex] + triangles_left[vertex];
+    }
+    std::vector<std::uint32_t> adjacency(indices.size());
+    {
+        std::vector<std::uint32_t> fill { adjacency_offsets.begin(), adjacency_offsets.end() - 1 };
+        for (std::size_t i { 0 }; i < indices.size(); i++) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<int> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (std::size_t vertex { 0 }; vertex < vertex_count; vertex++) {
+        vertex_scores[vertex] = vertex_score(-1, triangles_left[vertex]);
+    }
+
+    std::vector<bool> emitted(triangle_count, false);
+
+    // Room for the cache plus the three vertices pushed in before trimming.
+    std::array<std::uint32_t, cache_size + 3> cache {};
+    std::size_t cache_count { 0 };
+
+    std::vector<std::uint32_t> optimized;
+    optimized.reserve(indices.size());
+
+    std::size_t best_triangle { 0 };
+    std::size_t scan_start { 0 };
+    for (std::size_t emitted_count { 0 }; emitted_count < triangle_count; emitted_count++) {
+        if (best_triangle == triangle_count) {
+            // No triangle touches the cache, take the next one not emitted.
+            while (emitted[scan_start]) {
+                scan_start++;
+            }
+            best_triangle = scan_start;
+        }
+
+        emitted[best_triangle] = true;
+        const std::uint32_t* corners { indices.data() + best_triangle * 3 };
+
+        // Move the corners to the front of the cache.
+        std::array<std::uint32_t, cache_size + 3> new_cache {};
+        std::size_t new_cache_count { 0 };
+        for (std::size_t corner { 0 }; corner < 3; corner++) {
+            const std::uint32_t vertex { corners[corner] };
+            optimized.push_back(vertex);
+            new_cache[new_cache_count++] = vertex;
+
+            // Stop referencing the emitted triangle.
+            const auto begin { adjacency.begin() + adjacency_offsets[vertex] };
+            const auto end { begin + triangles_left[vertex] };
+            std::iter_swap(std::find(begin, end, best_triangle), end - 1);
+            triangles_left[vertex]--;
+        }
+        for (std::size_t i { 0 }; i < cache_count; i++) {
+            const std::uint32_t vertex { cache[i] };
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+        cache = new_cache;
+        cache_count = new_cache_count;
+
+        // Rescore everything in or just pushed out of the cache and pick the best
+        // triangle around it.
+        for (std::size_t i { 0 }; i < cache_count; i++) {
+            const std::uint32_t vertex { cache[i] };
+            cache_positions[vertex] = i < cache_size ? i : -1;
+            vertex_scores[vertex] = vertex_score(cache_positions[vertex], triangles_left[vertex]);
+        }
+        cache_count = std::min(cache_count, cache_size);
+
+        best_triangle = triangle_count;
+        float best_score { -1.0f };
+        for (std::size_t i { 0 }; i < new_cache_count; i++) {
+            const std::uint32_t vertex { new_cache[i] };
+            const std::uint32_t offset { adjacency_offsets[vertex] };
+            for (std::uint32_t j { 0 }; j < triangles_left[vertex]; j++) {
+                const std::uint32_t triangle { adjacency[offset + j] };
+                const float score { vertex_scores[indices[triangle * 3]]
+                    + vertex_scores[indices[triangle * 3 + 1]]
+                    + vertex_scores[indices[triangle * 3 + 2]] };
+                if (score > best_score) {
+                    best_score = score;
+                    best_triangle = triangle;
+                }
+            }
+        }
+    }
+
+    return optimized;
+}
+
+template<typename T>
+static void pack_indices(const std::vector<std::uint32_t>& indices, std::vector<std::byte>& packed) {
+    packed.resize(indices.size() * sizeof(T));
+    for (std::size_t i { 0 }; i < indices.size(); i++) {
+        const T index { static_cast<T>(indices[i]) };
+        std::memcpy(packed.data() + i * sizeof(T), &index, sizeof(T));
+    }
+}
+
+Mesh build_mesh(const std::span<const float> triangle_soup, const std::size_t floats_per_vertex) {
+    if (floats_per_vertex == 0 || triangle_soup.size() % (floats_per_vertex * 3) != 0) {
+        log_error("Triangle soup does not hold whole triangles.");
+        quit(1);
+    }
+
+    std::vector<float> unique_vertices;
+    const std::vector<std::uint32_t> soup_indices {
+        deduplicate(triangle_soup, floats_per_vertex, unique_vertices)
+    };
+    const std::size_t vertex_count { unique_vertices.size() / floats_per_vertex };
+    std::vector<std::uint32_t> indices { optimize_vertex_cache(soup_indices, vertex_count) };
+
+    // Lay vertices out in first use order so fetches walk the buffer forward.
+    Mesh mesh {
+        .vertices = {},
+        .floats_per_vertex = floats_per_vertex,
+        .vertex_count = vertex_count,
+        .indices = {},
+        .index_count = indices.size(),
+        .index_type = GL_UNSIGNED_INT
+    };
+    mesh.vertices.reserve(unique_vertices.size());
+    std::vector<std::uint32_t> new_index(vertex_count, no_vertex);
+    std::uint32_t next_index { 0 };
+    for (std::uint32_t& index : indices) {
+        if (new_index[index] == no_vertex) {
+            new_index[index] = next_index++;
+            const auto vertex { unique_vertices.begin() + index * floats_per_vertex };
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floats_per_vertex);
+        }
+        index = new_index[index];
+    }
+
+    if (vertex_count <= std::numeric_limits<std::uint8_t>::max() + 1) {
+        mesh.index_type = GL_UNSIGNED_BYTE;
+        pack_indices<std::uint8_t>(indices, mesh.indices);
+    } else if (vertex_count <= std::numeric_limits<std::uint16_t>::max() + 1) {
+        mesh.index_type = GL_UNSIGNED_SHORT;
+        pack_indices<std::uint16_t>(indices, mesh.indices);
+    } else {
+        pack_indices<std::uint32_t>(indices, mesh.indices);
+    }
+
+    return mesh;
+}
+
+std::size_t index_type_size(const GLenum index_type) {
+    switch (index_type) {
+    case GL_UNSIGNED_BYTE:
+        return sizeof(std::uint8_t);
+    case GL_UNSIGNED_SHORT:
+        return sizeof(std::uint16_t);
+    default:
+        return sizeof(std::uint32_t);
+    }
+}
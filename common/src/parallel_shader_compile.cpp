@@ -0,0 +1,43 @@
+#include <string_view>
+
+#include "parallel_shader_compile.hpp"
+
+using MaxShaderCompilerThreadsProc = void (*)(GLuint count);
+
+static bool supported { false };
+
+void load_parallel_shader_compile(GLADloadproc load) {
+    int extension_count {};
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+    const char* threads_proc_name { nullptr };
+    for (int i { 0 }; i < extension_count; i++) {
+        const std::string_view extension {
+            reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))
+        };
+        if (extension == "GL_KHR_parallel_shader_compile") {
+            threads_proc_name = "glMaxShaderCompilerThreadsKHR";
+            break;
+        }
+        if (extension == "GL_ARB_parallel_shader_compile") {
+            threads_proc_name = "glMaxShaderCompilerThreadsARB";
+        }
+    }
+
+    supported = threads_proc_name != nullptr;
+    if (!supported) {
+        return;
+    }
+
+    const auto max_shader_compiler_threads {
+        reinterpret_cast<MaxShaderCompilerThreadsProc>(load(threads_proc_name))
+    };
+    if (max_shader_compiler_threads != nullptr) {
+        // All ones leaves the thread count to the driver.
+        max_shader_compiler_threads(0xFFFFFFFF);
+    }
+}
+
+bool parallel_shader_compile_supported() {
+    return supported;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include "error_handling.hpp"
+#include "shader_preprocessor.hpp"
+
+static std::vector<std::filesystem::path> include_directories;
+
+static bool read_file(const std::filesystem::path& path, std::string& text) {
+    std::ifstream file { path };
+    if (!file) {
+        log_error(std::format("Failed to read shader '{}'", path.c_str()).c_str());
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+    return true;
+}
+
+// The quoted name of an #include line, empty for any other line.
+static std::string_view include_name(const std::string_view& line) {
+    const std::size_t directive { line.find_first_not_of(" \t") };
+    if (directive == std::string_view::npos || !line.substr(directive).starts_with("#include")) {
+        return {};
+    }
+
+    const std::size_t open { line.find('"', directive) };
+    const std::size_t close { line.find('"', open + 1) };
+    if (open == std::string_view::npos || close == std::string_view::npos) {
+        return {};
+    }
+    return line.substr(open + 1, close - open - 1);
+}
+
+static bool resolve_include(
+    const std::filesystem::path& including_file,
+    const std::string_view& name,
+    std::filesystem::path& path) {
+
+    path = including_file.parent_path() / name;
+    if (std::filesystem::exists(path)) {
+        return true;
+    }
+    for (const std::filesystem::path& directory : include_directories) {
+        path = directory / name;
+        if (std::filesystem::exists(path)) {
+            return true;
+        }
+    }
+
+    log_error(std::format("Shader include '{}' in '{}' not found", name,
+        including_file.c_str()).c_str());
+    return false;
+}
+
+// version_found is set when the #version line of the shader file is reached, the
+// defines follow it.
+static bool expand(
+    const std::size_t file_index,
+    const std::string& defines_block,
+    PreprocessedShader& shader,
+    bool& version_found) {
+
+    const std::filesystem::path path { shader.files[file_index] };
+    std::string text;
+    if (!read_file(path, text)) {
+        return false;
+    }
+
+    std::istringstream lines { text };
+    std::string line;
+    for (std::size_t line_number { 1 }; std::getline(lines, line); line_number++) {
+        if (file_index == 0 && !version_found && line.starts_with("#version")) {
+            version_found = true;
+            shader.code += line;
+            shader.code += '\n';
+            shader.code += defines_block;
+            shader.code += std::format("#line {} {}\n", line_number + 1, file_index);
+            continue;
+        }
+
+        const std::string_view name { include_name(line) };
+        if (name.empty()) {
+            shader.code += line;
+            shader.code += '\n';
+            continue;
+        }
+
+        std::filesystem::path include_path;
+        if (!resolve_include(path, name, include_path)) {
+            return false;
+        }
+        include_path = std::filesystem::weakly_canonical(include_path);
+
+        // Every file is included once, like with an include guard.
+        if (std::ranges::find(shader.files, include_path) == shader.files.end()) {
+            const std::size_t include_index { shader.files.size() };
+            shader.files.push_back(include_path);
+            shader.code += std::format("#line 1 {}\n", include_index);
+            if (!expand(include_index, defines_block, shader, version_found)) {
+                return false;
+            }
+        }
+        shader.code += std::format("#line {} {}\n", line_number + 1, file_index);
+    }
+    return true;
+}
+
+void add_shader_include_directory(const std::filesystem::path& directory) {
+    include_directories.push_back(directory);
+}
+
+bool preprocess_shader(
+    const std::filesystem::path& path,
+    const std::span<const std::string_view> defines,
+    PreprocessedShader& shader) {
+
+    std::string defines_block;
+    for (const std::string_view& define : defines) {
+        const std::size_t equals { define.find('=') };
+        if (equals == std::string_view::npos) {
+            defines_block += std::format("#define {} 1\n", define);
+        } else {
+            defines_block += std::format("#define {} {}\n", define.substr(0, equals),
+                define.substr(equals + 1));
+        }
+    }
+
+    shader.code.clear();
+    shader.files.assign(1, std::filesystem::weakly_canonical(path));
+    bool version_found { false };
+    if (!expand(0, defines_block, shader, version_found)) {
+        return false;
+    }
+
+    // Without it the defines would never be emitted and GLSL would fall back to
+    // version 110.
+    if (!version_found) {
+        log_error(std::format("Shader '{}' has no #version line", path.c_str()).c_str());
+        return false;
+    }
+    return true;
+}
@@ -25,15 +25,24 @@ Camera::Camera(
     , fov_min { fov_min }
     , fov_max { fov_max }
     , pos { position }
-    , front {}
-    , up { up }
-    , right {}
     , world_up { world_up }
     , fov_deg { fov_deg }
     , pitch_deg { pitch_deg }
-    , yaw_deg { yaw_deg } {
-
-    this->update_vectors();
+    , yaw_deg { yaw_deg }
+    , aspect_ratio { 1.0f }
+    , near_plane { 0.1f }
+    , far_plane { 100.0f }
+    , dirty { VECTORS | VIEW | PROJECTION | VIEW_PROJECTION | FRUSTUM }
+    , front {}
+    , up { up }
+    , right {}
+    , view {}
+    , inverse_view {}
+    , projection {}
+    , inverse_projection {}
+    , view_projection {}
+    , inverse_view_projection {}
+    , frustum {} {
 }
 
 // public
@@ -42,8 +51,76 @@ float Camera::get_fov_rad() const {
     return glm::radians(this->fov_deg);
 }
 
-glm::mat4 Camera::get_view_matrix() const {
-    return glm::lookAt(this->pos, this->pos + this->front, this->up);
+void Camera::set_perspective(
+    const float aspect_ratio,
+    const float near_plane,
+    const float far_plane) {
+
+    if (aspect_ratio == this->aspect_ratio && near_plane == this->near_plane
+        && far_plane == this->far_plane) {
+        return;
+    }
+    this->aspect_ratio = aspect_ratio;
+    this->near_plane = near_plane;
+    this->far_plane = far_plane;
+    this->dirty |= PROJECTION | VIEW_PROJECTION | FRUSTUM;
+}
+
+const glm::vec3& Camera::get_position() const {
+    return this->pos;
+}
+
+const glm::vec3& Camera::get_front() const {
+    this->update_vectors();
+    return this->front;
+}
+
+const glm::vec3& Camera::get_right() const {
+    this->update_vectors();
+    return this->right;
+}
+
+const glm::vec3& Camera::get_up() const {
+    this->update_vectors();
+    return this->up;
+}
+
+const glm::mat4& Camera::get_view_matrix() const {
+    this->update_view();
+    return this->view;
+}
+
+const glm::mat4& Camera::get_inverse_view_matrix() const {
+    this->update_view();
+    return this->inverse_view;
+}
+
+const glm::mat4& Camera::get_projection_matrix() const {
+    this->update_projection();
+    return this->projection;
+}
+
+const glm::mat4& Camera::get_inverse_projection_matrix() const {
+    this->update_projection();
+    return this->inverse_projection;
+}
+
+const glm::mat4& Camera::get_view_projection_matrix() const {
+    this->update_view_projection();
+    return this->view_projection;
+}
+
+const glm::mat4& Camera::get_inverse_view_projection_matrix() const {
+    this->update_view_projection();
+    return this->inverse_view_projection;
+}
+
+const Frustum& Camera::get_frustum() const {
+    if (this->dirty & FRUSTUM) {
+        this->frustum = Frustum::from_view_projection(this->get_view_projection_matrix());
+        this->dirty &= ~FRUSTUM;
+    }
+    return this->frustum;
 }
 
 void Camera::move_to_direction(
@@ -51,8 +128,9 @@ void Camera::move_to_direction(
     const float delta_time) {
 
     const float speed { this->move_speed * delta_time };
-
-    const glm::vec3 forward { this->front.x, 0.0f, this->front.z };
+    const glm::vec3& front { this->get_front() };
+    const glm::vec3& right { this->get_right() };
+    const glm::vec3 forward { front.x, 0.0f, front.z };
 
     switch (direction) {
     case Direction::FORWARD:
@@ -64,13 +142,14 @@ void Camera::move_to_direction(
         break;
 
     case Direction::LEFT:
-        this->pos -= this->right * speed;
+        this->pos -= right * speed;
         break;
 
     case Direction::RIGHT:
-        this->pos += this->right * speed;
+        this->pos += right * speed;
         break;
     }
+    this->dirty |= VIEW | VIEW_PROJECTION | FRUSTUM;
 }
 
 void Camera::process_mouse_move(
@@ -92,7 +171,8 @@ void Camera::process_mouse_move(
         }
     }
 
-    this->update_vectors();
+    // Several events per frame only accumulate, the vectors are recomputed once.
+    this->dirty |= VECTORS | VIEW | VIEW_PROJECTION | FRUSTUM;
 }
 
 void Camera::process_mouse_scroll(float offset_y) {
@@ -102,16 +182,63 @@ void Camera::process_mouse_scroll(float offset_y) {
     } else if (this->fov_deg > this->fov_max) {
         this->fov_deg = this->fov_max;
     }
+    this->dirty |= PROJECTION | VIEW_PROJECTION | FRUSTUM;
 }
 
 // private
 
-void Camera::update_vectors() {
+void Camera::update_vectors() const {
+    if (!(this->dirty & VECTORS)) {
+        return;
+    }
+
     this->front = glm::normalize(glm::vec3 {
         std::cos(glm::radians(this->yaw_deg)) * std::cos(glm::radians(this->pitch_deg)),
         std::sin(glm::radians(this->pitch_deg)),
         std::sin(glm::radians(this->yaw_deg)) * std::cos(glm::radians(this->pitch_deg)) });
-    
+
     this->right = glm::normalize(glm::cross(this->front, this->world_up));
     this->up = glm::normalize(glm::cross(this->right, this->front));
+    this->dirty &= ~VECTORS;
+}
+
+void Camera::update_view() const {
+    if (!(this->dirty & VIEW)) {
+        return;
+    }
+    this->update_vectors();
+
+    this->view = glm::lookAt(this->pos, this->pos + this->front, this->up);
+
+    // The basis is orthonormal, so the inverse is the camera's world transform.
+    this->inverse_view = glm::mat4 {
+        glm::vec4 { this->right, 0.0f },
+        glm::vec4 { this->up, 0.0f },
+        glm::vec4 { -this->front, 0.0f },
+        glm::vec4 { this->pos, 1.0f }
+    };
+    this->dirty &= ~VIEW;
+}
+
+void Camera::update_projection() const {
+    if (!(this->dirty & PROJECTION)) {
+        return;
+    }
+
+    this->projection = glm::perspective(this->get_fov_rad(), this->aspect_ratio,
+        this->near_plane, this->far_plane);
+    this->inverse_projection = glm::inverse(this->projection);
+    this->dirty &= ~PROJECTION;
+}
+
+void Camera::update_view_projection() const {
+    if (!(this->dirty & VIEW_PROJECTION)) {
+        return;
+    }
+    this->update_view();
+    this->update_projection();
+
+    this->view_projection = this->projection * this->view;
+    this->inverse_view_projection = this->inverse_view * this->inverse_projection;
+    this->dirty &= ~VIEW_PROJECTION;
 }
@@ -1,9 +1,16 @@
 #include <array>
 #include <assert.h>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <format>
+#include <optional>
 #include <print>
+#include <span>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,16 +19,27 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
 #include "Camera.hpp"
+#include "DrawQueue.hpp"
+#include "FrameAllocator.hpp"
+#include "GlState.hpp"
+#include "MeshFile.hpp"
+#include "SceneGraph.hpp"
 #include "Shader.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "TextureLoader.hpp"
 #include "error_handling.hpp"
+#include "frame_dump.hpp"
+#include "frame_uniforms.hpp"
+#include "headless.hpp"
+#include "mesh.hpp"
 #include "quit.hpp"
+#include "shader_preprocessor.hpp"
 
 static constexpr int window_width { 800 };
 static constexpr int window_height { 600 };
@@ -65,12 +83,26 @@ static struct {
     .last_y = window_height / 2.0f
 };
 
+// Per frame limit for texture uploads so loading never stalls a frame for long.
+static constexpr std::size_t texture_upload_budget { 16 * 1024 * 1024 };
+
 static float delta_time { 0.0f };
 static float last_frame { 0.0f };
+static const std::chrono::steady_clock::time_point start_time {
+    std::chrono::steady_clock::now()
+};
+
+static constexpr std::array texture_names { "container.jpg", "awesomeface.png" };
+// mix(texture(texture1, tex_coord), texture(texture2, tex_coord), 0.2) of
+// shader.frag
+static constexpr float texture_mix { 0.2f };
+static constexpr std::uint16_t cube_material { 0 };
+// Floats of the position and texture coord attributes of a cube vertex
+static constexpr std::array cube_attribute_sizes { 3, 2 };
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     (void) window;
-    glViewport(0, 0, width, height);
+    gl_state().viewport(0, 0, width, height);
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
@@ -119,55 +151,83 @@ void process_input(GLFWwindow* window) {
     }
 }
 
-unsigned int create_texture(const std::filesystem::path& img_path,
-    const int gl_pixel_data_format) {
-    if (!std::filesystem::exists(img_path)) {
-        log_error(std::format("The given image file '{}' does not exist.",
-            img_path.c_str())
-                .c_str());
-        quit(1);
-    }
+float seconds_since_start() {
+    const std::chrono::duration<float> elapsed { std::chrono::steady_clock::now() - start_time };
+    return elapsed.count();
+}
 
-    int img_w {};
-    int img_h {};
-    int img_nr_channels {};
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* img_data {
-        stbi_load(img_path.c_str(), &img_w, &img_h, &img_nr_channels, 0)
+SoftwareRasterizer::Texture load_software_texture(const std::filesystem::path& img_path) {
+    std::optional<SoftwareRasterizer::Texture> texture {
+        SoftwareRasterizer::load_texture(img_path)
     };
-    if (img_data == nullptr) {
-        log_error("Failed to load image.");
+    if (!texture.has_value()) {
+        log_error(std::format("Failed to load image '{}'.", img_path.c_str()).c_str());
         quit(1);
     }
+    return std::move(*texture);
+}
 
-    unsigned int texture {};
-    glGenTextures(1, &texture);
-
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img_w, img_h, 0, gl_pixel_data_format,
-        GL_UNSIGNED_BYTE, img_data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    stbi_image_free(img_data);
-    img_data = nullptr;
+// What the GL backend renders the cubes with, none of it is created with
+// --software. Shader include directories have to be set up first.
+struct GlRenderer {
+    TextureLoader texture_loader;
+    std::array<unsigned int, texture_names.size()> textures;
+    // Loaded from CUBE_MESH_PATH, the model matrices are added to its vertex array.
+    MeshBuffers cube_buffers;
+    unsigned int instance_vbo;
+    Shader shader;
+    // Camera matrices, one slice per frame
+    FrameAllocator frame_allocator;
+
+    explicit GlRenderer(const std::span<const glm::mat4> cube_models)
+        : texture_loader {}
+        , textures {}
+        , cube_buffers { MappedMesh { CUBE_MESH_PATH } }
+        , instance_vbo { 0 }
+        , shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() }
+        , frame_allocator { sizeof(FrameUniforms) } {
+
+        // Textures
+        constexpr std::array texture_formats { GL_RGB, GL_RGBA };
+        for (std::size_t i { 0 }; i < texture_names.size(); i++) {
+            this->textures[i] =
+                this->texture_loader.load(textures_path / texture_names[i], texture_formats[i]);
+        }
 
-    return texture;
-}
+        // Instance VBO
+        glCreateBuffers(1, &this->instance_vbo);
+        glNamedBufferStorage(this->instance_vbo, cube_models.size_bytes(), cube_models.data(), 0);
+
+        // model matrix attribute, one location per column after the mesh's
+        // position and texture coord attributes
+        const unsigned int vao { this->cube_buffers.vertex_array() };
+        constexpr unsigned int instance_binding { 1 };
+        glVertexArrayVertexBuffer(vao, instance_binding, this->instance_vbo, 0, sizeof(glm::mat4));
+        glVertexArrayBindingDivisor(vao, instance_binding, 1);
+        for (unsigned int column { 0 }; column < 4; column++) {
+            const unsigned int attrib_index {
+                static_cast<unsigned int>(cube_attribute_sizes.size()) + column
+            };
+            glVertexArrayAttribFormat(vao, attrib_index, 4, GL_FLOAT, GL_FALSE,
+                column * sizeof(glm::vec4));
+            glVertexArrayAttribBinding(vao, attrib_index, instance_binding);
+            glEnableVertexArrayAttrib(vao, attrib_index);
+        }
 
-int main() {
-    std::println("vertex_shader_path  : {}", vertex_shader_path.c_str());
-    std::println("fragment_shader_path: {}", fragment_shader_path.c_str());
-    std::println("textures_path       : {}", textures_path.c_str());
+        // Shaders
+        this->shader.use();
+        this->shader.set_int("texture1", 0);
+        this->shader.set_int("texture2", 1);
+    }
+};
 
-    // GLFW
+GLFWwindow* create_window() {
     if (glfwInit() != GLFW_TRUE) {
         const char* description;
         const int err { glfwGetError(&description) };
         std::println(stderr, "glfwInit failed. Error code: {}. Description: {}",
             err, description);
-        return 1;
+        quit(1);
     }
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -191,26 +251,47 @@ int main() {
         quit(1);
     }
 
-    glViewport(0, 0, window_width, window_height);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    glEnable(GL_DEPTH_TEST);
-
-    // Textures
-    std::filesystem::path texture1_path { textures_path };
-    texture1_path.append("container.jpg");
-    const unsigned int texture1 { create_texture(texture1_path, GL_RGB) };
+    return window;
+}
 
-    std::filesystem::path texture2_path { textures_path };
-    texture2_path.append("awesomeface.png");
-    const unsigned int texture2 { create_texture(texture2_path, GL_RGBA) };
+int main(int argc, char** argv) {
+    // Command line
+    int headless_frames { 0 };
+    std::filesystem::path software_image_path {};
+    for (int i { 1 }; i < argc; i++) {
+        const std::string_view arg { argv[i] };
+        if (arg == "--software" && i + 1 < argc) {
+            software_image_path = argv[++i];
+            continue;
+        }
+        if (arg == "--headless" && i + 1 < argc) {
+            const std::string_view value { argv[++i] };
+            const auto result {
+                std::from_chars(value.data(), value.data() + value.size(), headless_frames)
+            };
+            if (result.ec == std::errc {} && headless_frames > 0) {
+                continue;
+            }
+        }
+        std::println(stderr, "Usage: {} [--headless <frame count>] [--software <ppm file>]",
+            argv[0]);
+        return 1;
+    }
+    // The software backend renders on the CPU without a window, one frame unless
+    // --headless asks for more, and writes the last one to the given file.
+    const bool software { !software_image_path.empty() };
+    if (software && headless_frames == 0) {
+        headless_frames = 1;
+    }
+    const bool headless { headless_frames > 0 };
 
-    // VAO
-    unsigned int vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    std::println("vertex_shader_path  : {}", vertex_shader_path.c_str());
+    std::println("fragment_shader_path: {}", fragment_shader_path.c_str());
+    std::println("textures_path       : {}", textures_path.c_str());
 
-    // VBO
+    // Geometry
     // clang-format off
     constexpr const std::array vertices {
         -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
@@ -256,52 +337,9 @@ int main() {
         -0.5f, 0.5f, -0.5f, 0.0f, 1.0f
     };
     // clang-format on
-
-    unsigned int vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
-        GL_STATIC_DRAW);
-
-    // position attribute
-    unsigned int attrib_index { 0 };
-    int elem_count { 3 };
-    std::size_t stride { 5 * sizeof(float) };
-    void* first_value { (void*) 0 };
-    glVertexAttribPointer(attrib_index, elem_count, GL_FLOAT, GL_FALSE, stride,
-        first_value);
-    glEnableVertexAttribArray(attrib_index);
-    // texture coord attribute
-    attrib_index++;
-    elem_count = 2;
-    first_value = (void*) (3 * sizeof(float));
-    glVertexAttribPointer(attrib_index, elem_count, GL_FLOAT, GL_FALSE, stride,
-        first_value);
-    glEnableVertexAttribArray(attrib_index);
-
-    // EBO
-    // constexpr const std::array<unsigned int, 6> indices {
-    //     0, 1, 3,
-    //     1, 2, 3
-    // };
-    //
-    // unsigned int ebo;
-    // glGenBuffers(1, &ebo);
-    //
-    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    // glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(),
-    // GL_STATIC_DRAW);
-
-    // Done setting up VAO.
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    // Shaders
-    Shader shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() };
-    shader.use();
-    shader.setInt("texture1", 0);
-    shader.setInt("texture2", 1);
+    // meshes/cube.mesh is these vertices written with write_mesh_file() and
+    // cube_attribute_sizes, it has to be baked again when they change.
+    const Mesh cube_mesh { build_mesh(vertices, 5) };
 
     constexpr std::array cube_positions {
         glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 5.0f, -15.0f),
@@ -311,45 +349,146 @@ int main() {
         glm::vec3(1.5f, 0.2f, -1.5f), glm::vec3(-1.3f, 1.0f, -1.5f)
     };
 
+    // The cubes hang off one root, their world matrices are the instance data.
+    SceneGraph scene_graph {};
+    const SceneGraph::Node cubes_root { scene_graph.add_root(glm::vec3 { 0.0f }) };
+    const glm::vec3 rotation_axis { glm::normalize(glm::vec3 { 1.0f, 0.3f, 0.5f }) };
+    for (std::size_t i { 0 }; i < cube_positions.size(); i++) {
+        const float angle { glm::radians(20.0f * i) };
+        scene_graph.add_child(cubes_root, cube_positions[i], glm::angleAxis(angle, rotation_axis));
+    }
+    scene_graph.update();
+    const std::span<const glm::mat4> cube_models { scene_graph.world_matrices(cubes_root.level + 1) };
+
+    // Context and backend
+    GLFWwindow* window { nullptr };
+    std::optional<SoftwareRasterizer> rasterizer {};
+    std::optional<GlRenderer> gl {};
+    std::array<SoftwareRasterizer::Texture, texture_names.size()> software_textures {};
+    if (software) {
+        rasterizer.emplace(window_width, window_height);
+        for (std::size_t i { 0 }; i < texture_names.size(); i++) {
+            software_textures[i] = load_software_texture(textures_path / texture_names[i]);
+        }
+    } else {
+        if (headless) {
+            create_headless_context(window_width, window_height);
+        } else {
+            window = create_window();
+        }
+
+        gl_state().viewport(0, 0, window_width, window_height);
+        gl_state().set_enabled(GL_DEPTH_TEST, true);
+
+        add_shader_include_directory(SHADER_INCLUDE_PATH);
+        Shader::set_uniform_block_binding(frame_uniform_block, frame_uniform_binding);
+        gl.emplace(cube_models);
+    }
+
+    // Draws carry no per object block, the GL backend never binds one.
+    DrawQueue draw_queue { software
+            ? DrawQueue { *rasterizer }
+            : DrawQueue { GL_UNIFORM_BUFFER, 0 } };
+    draw_queue.set_software_material(cube_material, SoftwareRasterizer::Material {
+        .color = glm::vec3 { 1.0f },
+        .texture0 = &software_textures[0],
+        .texture1 = &software_textures[1],
+        .texture_mix = texture_mix });
+
+    // Headless frame times in milliseconds
+    std::vector<float> frame_times;
+    frame_times.reserve(headless_frames);
+
     // Render loop
-    while (!glfwWindowShouldClose(window)) {
-        const float current_time { static_cast<float>(glfwGetTime()) };
+    while (headless ? std::cmp_less(frame_times.size(), headless_frames) : !glfwWindowShouldClose(window)) {
+        const float current_time { seconds_since_start() };
         delta_time = current_time - last_frame;
         last_frame = current_time;
 
-        process_input(window);
-
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (!headless) {
+            process_input(window);
+        }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        if (gl) {
+            gl->texture_loader.upload_pending(texture_upload_budget);
+        }
 
-        const glm::mat4 view { camera.get_view_matrix() };
-        shader.setMat4("view", view);
+        constexpr glm::vec3 clear_color { 0.2f, 0.3f, 0.3f };
+        if (rasterizer) {
+            rasterizer->clear(clear_color);
+        } else {
+            glClearColor(clear_color.r, clear_color.g, clear_color.b, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         constexpr float aspect_ratio { static_cast<float>(window_width) / window_height };
         constexpr float near_plane { 0.1f };
         constexpr float far_plane { 100.0f };
-        const glm::mat4 projection {
-            glm::perspective(camera.get_fov_rad(), aspect_ratio, near_plane, far_plane)
-        };
-        shader.setMat4("projection", projection);
-
-        glBindVertexArray(vao);
-        for (std::size_t i { 0 }; i < cube_positions.size(); i++) {
-            glm::mat4 model { 1.0f };
-            model = glm::translate(model, cube_positions[i]);
-            const float angle { glm::radians(20.0f * i) };
-            model = glm::rotate(model, angle, glm::vec3 { 1.0f, 0.3f, 0.5f });
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        camera.set_perspective(aspect_ratio, near_plane, far_plane);
+        if (rasterizer) {
+            rasterizer->set_view_projection(camera.get_projection_matrix() * camera.get_view_matrix());
+        } else {
+            gl->frame_allocator.begin_frame();
+            const FrameUniforms frame_uniforms {
+                .view = camera.get_view_matrix(),
+                .projection = camera.get_projection_matrix(),
+                .viewport = glm::vec4 {
+                    window_width, window_height, 1.0f / window_width, 1.0f / window_height
+                },
+                .time = current_time,
+                .padding = {}
+            };
+            gl->frame_allocator.bind(gl->frame_allocator.push(frame_uniforms), GL_UNIFORM_BUFFER,
+                frame_uniform_binding);
+        }
+
+        draw_queue.push(DrawQueue::Draw {
+            .pass = DrawQueue::Pass::OPAQUE,
+            .program = gl ? gl->shader.id() : 0,
+            .material = cube_material,
+            .textures = { gl ? gl->textures[0] : 0, gl ? gl->textures[1] : 0 },
+            .vertex_array = gl ? gl->cube_buffers.vertex_array() : 0,
+            .depth = 0.0f,
+            .mode = GL_TRIANGLES,
+            .index_count = gl ? gl->cube_buffers.index_count() : 0,
+            .index_type = gl ? gl->cube_buffers.index_type() : GL_NONE,
+            .index_offset = 0,
+            .base_vertex = 0,
+            .instance_count = static_cast<GLsizei>(cube_models.size()),
+            .object_buffer = 0,
+            .object_offset = 0,
+            .object_size = 0,
+            .mesh = &cube_mesh,
+            .models = cube_models
+        });
+        draw_queue.submit();
+
+        if (gl) {
+            gl->frame_allocator.end_frame();
+        }
+
+        if (headless) {
+            // Wait for the frame so the measured time includes rendering.
+            if (rasterizer) {
+                rasterizer->finish();
+            } else {
+                glFinish();
+            }
+            frame_times.push_back((seconds_since_start() - current_time) * 1000.0f);
+        } else {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
+    }
+
+    if (headless) {
+        print_frame_times(frame_times);
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    if (rasterizer) {
+        dump_frame(*rasterizer, software_image_path);
+    } else if (headless) {
+        destroy_headless_context();
     }
 
     quit(0);
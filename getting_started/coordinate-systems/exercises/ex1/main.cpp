@@ -7,15 +7,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "Shader.h"
-#include "error_handling.h"
-#include "quit.h"
+#include "Shader.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
 
 #define UNUSED(x) (void) x
 
@@ -208,12 +207,12 @@ int main() {
     // Shaders
     Shader shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() };
     shader.use();
-    shader.setInt("texture1", 0);
-    shader.setInt("texture2", 1);
+    shader.set_int("texture1", 0);
+    shader.set_int("texture2", 1);
 
     glm::mat4 view { 1.0f };
     view = glm::translate(view, glm::vec3 { 0.0f, 0.0f, -3.0f });
-    shader.setMat4("view", view);
+    shader.set_mat4("view", view);
 
     constexpr const std::array cube_positions {
         glm::vec3(0.0f, 0.0f, 0.0f),
@@ -275,7 +274,7 @@ int main() {
                 far_plane)
         };
         // glm::mat4 projection { 1.0f };
-        shader.setMat4("projection", projection);
+        shader.set_mat4("projection", projection);
 
         glBindVertexArray(vao);
         for (std::size_t i { 0 }; i < cube_positions.size(); i++) {
@@ -283,7 +282,7 @@ int main() {
             model = glm::translate(model, cube_positions[i]);
             const float angle { glm::radians(20.0f * i) };
             model = glm::rotate(model, angle, glm::vec3 { 1.0f, 0.3f, 0.5f });
-            shader.setMat4("model", model);
+            shader.set_mat4("model", model);
             glDrawArrays(GL_TRIANGLES, 0, vertices.size());
         }
 
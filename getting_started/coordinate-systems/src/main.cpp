@@ -7,15 +7,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "Shader.h"
-#include "error_handling.h"
-#include "quit.h"
+#include "Shader.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
 
 #define UNUSED(x) (void) x
 
@@ -168,6 +167,7 @@ int main() {
         -0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
         -0.5f, 0.5f, -0.5f, 0.0f, 1.0f
     };
+    constexpr std::size_t vertex_count { vertices.size() / 5 };
 
     unsigned int vbo;
     glGenBuffers(1, &vbo);
@@ -188,6 +188,45 @@ int main() {
     glVertexAttribPointer(attrib_index, elem_count, GL_FLOAT, GL_FALSE, stride, first_value);
     glEnableVertexAttribArray(attrib_index);
 
+    // Instance VBO
+    constexpr const std::array cube_positions {
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(2.0f, 5.0f, -15.0f),
+        glm::vec3(-1.5f, -2.2f, -2.5f),
+        glm::vec3(-3.8f, -2.0f, -12.3f),
+        glm::vec3(2.4f, -0.4f, -3.5f),
+        glm::vec3(-1.7f, 3.0f, -7.5f),
+        glm::vec3(1.3f, -2.0f, -2.5f),
+        glm::vec3(1.5f, 2.0f, -2.5f),
+        glm::vec3(1.5f, 0.2f, -1.5f),
+        glm::vec3(-1.3f, 1.0f, -1.5f)
+    };
+
+    std::array<glm::mat4, cube_positions.size()> cube_models {};
+    for (std::size_t i { 0 }; i < cube_positions.size(); i++) {
+        glm::mat4 model { 1.0f };
+        model = glm::translate(model, cube_positions[i]);
+        const float angle { glm::radians(20.0f * i) };
+        model = glm::rotate(model, angle, glm::vec3 { 1.0f, 0.3f, 0.5f });
+        cube_models[i] = model;
+    }
+
+    unsigned int instance_vbo;
+    glGenBuffers(1, &instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_models), cube_models.data(), GL_STATIC_DRAW);
+
+    // model matrix attribute, one location per column
+    attrib_index++;
+    elem_count = 4;
+    stride = sizeof(glm::mat4);
+    for (unsigned int column { 0 }; column < 4; column++) {
+        first_value = (void*) (column * sizeof(glm::vec4));
+        glVertexAttribPointer(attrib_index + column, elem_count, GL_FLOAT, GL_FALSE, stride, first_value);
+        glEnableVertexAttribArray(attrib_index + column);
+        glVertexAttribDivisor(attrib_index + column, 1);
+    }
+
     // EBO
     // constexpr const std::array<unsigned int, 6> indices {
     //     0, 1, 3,
@@ -208,12 +247,12 @@ int main() {
     // Shaders
     Shader shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() };
     shader.use();
-    shader.setInt("texture1", 0);
-    shader.setInt("texture2", 1);
+    shader.set_int("texture1", 0);
+    shader.set_int("texture2", 1);
 
     glm::mat4 view { 1.0f };
     view = glm::translate(view, glm::vec3 { 0.0f, 0.0f, -3.0f });
-    shader.setMat4("view", view);
+    shader.set_mat4("view", view);
 
     constexpr const float fov { glm::radians(45.0f) };
     constexpr const float aspect_ratio { static_cast<float>(window_width) / window_height };
@@ -227,20 +266,7 @@ int main() {
             far_plane)
     };
     // glm::mat4 projection { 1.0f };
-    shader.setMat4("projection", projection);
-
-    constexpr const std::array cube_positions {
-        glm::vec3(0.0f, 0.0f, 0.0f),
-        glm::vec3(2.0f, 5.0f, -15.0f),
-        glm::vec3(-1.5f, -2.2f, -2.5f),
-        glm::vec3(-3.8f, -2.0f, -12.3f),
-        glm::vec3(2.4f, -0.4f, -3.5f),
-        glm::vec3(-1.7f, 3.0f, -7.5f),
-        glm::vec3(1.3f, -2.0f, -2.5f),
-        glm::vec3(1.5f, 2.0f, -2.5f),
-        glm::vec3(1.5f, 0.2f, -1.5f),
-        glm::vec3(-1.3f, 1.0f, -1.5f)
-    };
+    shader.set_mat4("projection", projection);
 
     // Render loop
     while (!glfwWindowShouldClose(window)) {
@@ -255,14 +281,7 @@ int main() {
         glBindTexture(GL_TEXTURE_2D, texture2);
 
         glBindVertexArray(vao);
-        for (std::size_t i { 0 }; i < cube_positions.size(); i++) {
-            glm::mat4 model { 1.0f };
-            model = glm::translate(model, cube_positions[i]);
-            const float angle { glm::radians(20.0f * i) };
-            model = glm::rotate(model, angle, glm::vec3 { 1.0f, 0.3f, 0.5f });
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, vertices.size());
-        }
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertex_count, cube_models.size());
 
         glfwSwapBuffers(window);
         glfwPollEvents();
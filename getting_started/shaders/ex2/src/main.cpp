@@ -5,8 +5,8 @@
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "quit.h"
-#include "Shader.h"
+#include "quit.hpp"
+#include "Shader.hpp"
 
 #define UNUSED(x) (void)x
 
@@ -94,7 +94,7 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT);
 
         shader.use();
-        shader.setFloat("horizontal_offset", 0.5f);
+        shader.set_float("horizontal_offset", 0.5f);
         glBindVertexArray(vao);
         glDrawArrays(GL_TRIANGLES, 0, 3);
 
@@ -5,8 +5,8 @@
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "quit.h"
-#include "Shader.h"
+#include "quit.hpp"
+#include "Shader.hpp"
 
 #define UNUSED(x) (void)x
 
@@ -3,15 +3,14 @@
 #include <filesystem>
 #include <print>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "Shader.h"
-#include "error_handling.h"
-#include "quit.h"
+#include "Shader.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
 
 #define UNUSED(x) (void)x
 
@@ -177,8 +176,8 @@ int main() {
     // Shaders
     Shader shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() };
     shader.use();
-    shader.setInt("texture1", 0);
-    shader.setInt("texture2", 1);
+    shader.set_int("texture1", 0);
+    shader.set_int("texture2", 1);
 
     // Render loop
     while (!glfwWindowShouldClose(window)) {
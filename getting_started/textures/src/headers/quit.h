@@ -1,6 +0,0 @@
-#ifndef QUIT_H_
-#define QUIT_H_
-
-void quit(int status_code);
-
-#endif // QUIT_H_
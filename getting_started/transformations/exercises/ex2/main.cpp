@@ -7,15 +7,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
-#include "Shader.h"
-#include "error_handling.h"
-#include "quit.h"
+#include "Shader.hpp"
+#include "error_handling.hpp"
+#include "quit.hpp"
 
 #define UNUSED(x) (void) x
 
@@ -172,8 +171,8 @@ int main() {
     // Shaders
     Shader shader { vertex_shader_path.c_str(), fragment_shader_path.c_str() };
     shader.use();
-    shader.setInt("texture1", 0);
-    shader.setInt("texture2", 1);
+    shader.set_int("texture1", 0);
+    shader.set_int("texture2", 1);
 
     // Render loop
     while (!glfwWindowShouldClose(window)) {
@@ -193,7 +192,7 @@ int main() {
         {
             transform = glm::translate(transform, glm::vec3(0.5f, -0.5f, 0.0f));
             transform = glm::rotate(transform, current_time, glm::vec3(0.0f, 0.0f, 1.0f));
-            shader.setMat4("transform", transform);
+            shader.set_mat4("transform", transform);
 
             glBindVertexArray(vao);
             glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
@@ -203,7 +202,7 @@ int main() {
             transform = glm::mat4 { 1.0f };
             transform = glm::translate(transform, glm::vec3 { -0.5f, 0.5f, 0.0f });
             transform = glm::scale(transform, glm::vec3 { glm::sin(current_time) });
-            shader.setMat4("transform", transform);
+            shader.set_mat4("transform", transform);
 
             glBindVertexArray(vao);
             glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
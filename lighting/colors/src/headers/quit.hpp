@@ -1,4 +0,0 @@
-#pragma once
-
-void quit(int status_code);
-
@@ -1,9 +1,18 @@
+#include <algorithm>
 #include <array>
 #include <assert.h>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <format>
+#include <optional>
 #include <print>
+#include <span>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,16 +21,34 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 
 #include "Camera.hpp"
+#include "DrawQueue.hpp"
+#include "FrameAllocator.hpp"
+#include "Frustum.hpp"
+#include "GlState.hpp"
+#include "GpuCulling.hpp"
+#include "MeshPool.hpp"
+#include "Profiler.hpp"
+#include "ProgramCache.hpp"
 #include "Shader.hpp"
+#include "ShaderVariants.hpp"
+#include "ShaderWatcher.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "TransformStore.hpp"
+#include "culling.hpp"
 #include "error_handling.hpp"
+#include "frame_dump.hpp"
+#include "frame_uniforms.hpp"
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "parallel_shader_compile.hpp"
 #include "quit.hpp"
+#include "shader_preprocessor.hpp"
 
 static constexpr int window_width { 800 };
 static constexpr int window_height { 600 };
@@ -55,12 +82,34 @@ static struct {
 
 static float delta_time { 0.0f };
 static float last_frame { 0.0f };
+static const std::chrono::steady_clock::time_point start_time {
+    std::chrono::steady_clock::now()
+};
 
 static glm::vec3 light_pos { 1.2f, 1.0f, 2.0f };
+// light_color * object_color of shader.frag
+static constexpr glm::vec3 object_color { 1.0f, 0.5f, 0.31f };
+static constexpr glm::vec3 light_color { 1.0f, 1.0f, 1.0f };
+
+// Binding of the Objects storage block in shader.vert, culled cubes are drawn
+// with their models at the same binding.
+static constexpr unsigned int object_block_binding { GpuCulling::visible_model_binding };
+static constexpr std::size_t frame_data_size { 64 * 1024 };
+// Spacing of the extra cubes added with --objects
+static constexpr float object_grid_spacing { 2.0f };
+// Bounding sphere radius of the unit cube, half its diagonal
+static constexpr float cube_radius { 0.8660254f };
+
+static constexpr std::array position_attribute { 3 };
+static constexpr std::array light_source_defines { std::string_view { "LIGHT_SOURCE" } };
+
+// Materials of the draw queue
+static constexpr std::uint16_t cube_material { 0 };
+static constexpr std::uint16_t light_source_material { 1 };
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     (void) window;
-    glViewport(0, 0, width, height);
+    gl_state().viewport(0, 0, width, height);
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
@@ -133,12 +182,12 @@ unsigned int create_texture(const std::filesystem::path& img_path,
     unsigned int texture {};
     glGenTextures(1, &texture);
 
-    glBindTexture(GL_TEXTURE_2D, texture);
+    gl_state().bind_texture(0, GL_TEXTURE_2D, texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img_w, img_h, 0, gl_pixel_data_format,
         GL_UNSIGNED_BYTE, img_data);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl_state().bind_texture(0, GL_TEXTURE_2D, 0);
 
     stbi_image_free(img_data);
     img_data = nullptr;
@@ -146,14 +195,27 @@ unsigned int create_texture(const std::filesystem::path& img_path,
     return texture;
 }
 
-int main() {
-    // GLFW
+// Position of extra cube i in the square grid behind the first cube
+glm::vec3 extra_cube_position(const int i, const int grid_side) {
+    return glm::vec3 {
+        (i % grid_side - grid_side / 2) * object_grid_spacing,
+        -2.0f,
+        -(i / grid_side + 2) * object_grid_spacing
+    };
+}
+
+float seconds_since_start() {
+    const std::chrono::duration<float> elapsed { std::chrono::steady_clock::now() - start_time };
+    return elapsed.count();
+}
+
+GLFWwindow* create_window() {
     if (glfwInit() != GLFW_TRUE) {
         const char* description;
         const int err { glfwGetError(&description) };
         std::println(stderr, "glfwInit failed. Error code: {}. Description: {}",
             err, description);
-        return 1;
+        quit(1);
     }
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -176,11 +238,121 @@ int main() {
         std::println(stderr, "Failed to init GLAD.");
         quit(1);
     }
+    load_parallel_shader_compile((GLADloadproc) glfwGetProcAddress);
 
-    glViewport(0, 0, window_width, window_height);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    glEnable(GL_DEPTH_TEST);
+    return window;
+}
+
+// The cubes with their model matrices written in place by the transform store
+std::vector<GpuCulling::Object> make_cube_objects(
+    const MeshPool::Range& cube_range,
+    const TransformStore& cube_transforms) {
+
+    std::vector<GpuCulling::Object> objects(cube_transforms.size(),
+        GpuCulling::make_object(cube_range, glm::mat4 { 1.0f }, cube_radius));
+    for (TransformStore::Index i { 0 }; i < objects.size(); i++) {
+        objects[i].sphere = glm::vec4 { cube_transforms.position(i), cube_radius };
+    }
+    cube_transforms.write_model_matrices(0, objects.size(), &objects[0].model,
+        sizeof(GpuCulling::Object));
+    return objects;
+}
+
+// What the GL backend renders the scene with, none of it is created with
+// --software. Shader include directories have to be set up first.
+struct GlRenderer {
+    // All cubes and the light source share the pool's vertex array.
+    MeshPool mesh_pool;
+    MeshPool::Range cube_range;
+
+    // Shaders, built together in the constructor
+    ProgramCache program_cache;
+    ShaderVariants shader_variants;
+    Shader& shader;
+    Shader& light_source_shader;
+    Shader& culling_shader;
+    Shader::Uniform<glm::vec3> object_color_uniform;
+    Shader::Uniform<glm::vec3> light_color_uniform;
+
+    // Culls the cubes on the GPU, they are drawn by one multi draw.
+    GpuCulling gpu_culling;
+    FrameAllocator frame_allocator;
+    // Shaders are rebuilt when their files change
+    ShaderWatcher shader_watcher;
+
+    GlRenderer(const Mesh& cube_mesh, const TransformStore& cube_transforms)
+        : mesh_pool { position_attribute, cube_mesh.vertex_count, cube_mesh.index_count }
+        , cube_range { this->mesh_pool.add(cube_mesh) }
+        , program_cache { PROGRAM_CACHE_PATH }
+        , shader_variants { &this->program_cache }
+        , shader { this->shader_variants.get("../src/shaders/shader.vert",
+              "../src/shaders/shader.frag") }
+        , light_source_shader { this->shader_variants.get("../src/shaders/shader.vert",
+              "../src/shaders/shader.frag", light_source_defines) }
+        , culling_shader { this->shader_variants.get("../src/shaders/cull.comp") }
+        , object_color_uniform { this->shader.get_uniform<glm::vec3>("object_color") }
+        , light_color_uniform { this->shader.get_uniform<glm::vec3>("light_color") }
+        , gpu_culling { this->culling_shader, make_cube_objects(this->cube_range, cube_transforms) }
+        , frame_allocator { frame_data_size }
+        , shader_watcher {} {
+
+        this->shader_variants.finish_builds();
+
+        this->shader_watcher.watch(this->shader);
+        this->shader_watcher.watch(this->light_source_shader);
+        this->shader_watcher.watch(this->culling_shader);
+    }
+};
+
+int main(int argc, char** argv) {
+    // Command line
+    int headless_frames { 0 };
+    int extra_objects { 0 };
+    std::filesystem::path trace_path {};
+    std::filesystem::path software_image_path {};
+    for (int i { 1 }; i < argc; i++) {
+        const std::string_view arg { argv[i] };
+        if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+            continue;
+        }
+        if (arg == "--software" && i + 1 < argc) {
+            software_image_path = argv[++i];
+            continue;
+        }
+        if (arg == "--headless" && i + 1 < argc) {
+            const std::string_view value { argv[++i] };
+            const auto result {
+                std::from_chars(value.data(), value.data() + value.size(), headless_frames)
+            };
+            if (result.ec == std::errc {} && headless_frames > 0) {
+                continue;
+            }
+        }
+        if (arg == "--objects" && i + 1 < argc) {
+            const std::string_view value { argv[++i] };
+            const auto result {
+                std::from_chars(value.data(), value.data() + value.size(), extra_objects)
+            };
+            if (result.ec == std::errc {} && extra_objects >= 0) {
+                continue;
+            }
+        }
+        std::println(stderr,
+            "Usage: {} [--headless <frame count>] [--trace <file>] [--objects <extra cube count>] "
+            "[--software <ppm file>]",
+            argv[0]);
+        return 1;
+    }
+    // The software backend renders on the CPU without a window, one frame unless
+    // --headless asks for more, and writes the last one to the given file.
+    const bool software { !software_image_path.empty() };
+    if (software && headless_frames == 0) {
+        headless_frames = 1;
+    }
+    const bool headless { headless_frames > 0 };
 
     // clang-format off
     constexpr const std::array cube_vertices {
@@ -227,91 +399,292 @@ int main() {
         -0.5f, 0.5f, -0.5f,
     };
     // clang-format on
+    const Mesh cube_mesh { build_mesh(cube_vertices, 3) };
+
+    // The scene, the same for both backends: the cube first and then the extra
+    // cubes in a square grid behind it, and the light source.
+    const int grid_side { static_cast<int>(std::ceil(std::sqrt(extra_objects))) };
+    TransformStore cube_transforms {};
+    cube_transforms.reserve(1 + static_cast<std::size_t>(extra_objects));
+    cube_transforms.add(glm::vec3 { 0.0f });
+    for (int i { 0 }; i < extra_objects; i++) {
+        cube_transforms.add(extra_cube_position(i, grid_side));
+    }
 
-    unsigned int cube_vao;
-    glGenVertexArrays(1, &cube_vao);
-    glBindVertexArray(cube_vao);
+    const glm::mat4 light_source_model {
+        glm::scale(glm::translate(glm::mat4 { 1.0f }, light_pos), glm::vec3 { 0.2f })
+    };
+    const std::array light_source_radius { cube_radius * 0.2f };
+    const BoundingSpheres light_source_bounds {
+        .center_x = &light_pos.x,
+        .center_y = &light_pos.y,
+        .center_z = &light_pos.z,
+        .radius = light_source_radius.data(),
+        .count = light_source_radius.size()
+    };
+    std::vector<std::uint32_t> visible_light_sources;
+
+    // Context and backend
+    GLFWwindow* window { nullptr };
+    std::optional<SoftwareRasterizer> rasterizer {};
+    std::optional<GlRenderer> gl {};
+    if (software) {
+        rasterizer.emplace(window_width, window_height);
+    } else {
+        if (headless) {
+            create_headless_context(window_width, window_height);
+        } else {
+            window = create_window();
+        }
+
+        gl_state().viewport(0, 0, window_width, window_height);
+
+        gl_state().set_enabled(GL_DEPTH_TEST, true);
+
+        add_shader_include_directory(SHADER_INCLUDE_PATH);
+        Shader::set_uniform_block_binding(frame_uniform_block, frame_uniform_binding);
+        gl.emplace(cube_mesh, cube_transforms);
+    }
 
-    unsigned int cube_vbo;
-    glGenBuffers(1, &cube_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, cube_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices.data(),
-        GL_STATIC_DRAW);
+    // Draws that are not batched go through the draw queue, the software backend
+    // draws everything through it.
+    DrawQueue draw_queue { software
+            ? DrawQueue { *rasterizer }
+            : DrawQueue { GL_SHADER_STORAGE_BUFFER, object_block_binding } };
+    // The fragment colors of shader.frag and of its LIGHT_SOURCE variant
+    draw_queue.set_software_material(cube_material, SoftwareRasterizer::Material {
+        .color = light_color * object_color,
+        .texture0 = nullptr,
+        .texture1 = nullptr,
+        .texture_mix = 0.0f });
+    draw_queue.set_software_material(light_source_material, SoftwareRasterizer::Material {
+        .color = glm::vec3 { 1.0f },
+        .texture0 = nullptr,
+        .texture1 = nullptr,
+        .texture_mix = 0.0f });
+
+    // Without the GPU the cubes are culled on the CPU, the visible ones are drawn
+    // as instances of one draw.
+    std::vector<glm::mat4> cube_models {};
+    std::array<std::vector<float>, 3> cube_centers {};
+    std::vector<float> cube_radii {};
+    if (software) {
+        cube_models.resize(cube_transforms.size());
+        cube_transforms.write_model_matrices(cube_models);
+        for (TransformStore::Index i { 0 }; i < cube_transforms.size(); i++) {
+            const glm::vec3 position { cube_transforms.position(i) };
+            for (std::size_t axis { 0 }; axis < 3; axis++) {
+                cube_centers[axis].push_back(position[axis]);
+            }
+        }
+        cube_radii.assign(cube_transforms.size(), cube_radius);
+    }
+    const BoundingSpheres cube_bounds {
+        .center_x = cube_centers[0].data(),
+        .center_y = cube_centers[1].data(),
+        .center_z = cube_centers[2].data(),
+        .radius = cube_radii.data(),
+        .count = cube_radii.size()
+    };
+    std::vector<std::uint32_t> visible_cubes;
+    std::vector<glm::mat4> visible_cube_models;
 
-    unsigned int attrib_index { 0 };
-    int elem_count { 3 };
-    std::size_t stride { 3 * sizeof(float) };
-    void* first_value { (void*) 0 };
-    glVertexAttribPointer(attrib_index, elem_count, GL_FLOAT, GL_FALSE, stride,
-        first_value);
-    glEnableVertexAttribArray(attrib_index);
+    // Written as a Chrome trace when the program ends, the software backend only
+    // records CPU zones.
+    Profiler profiler { !trace_path.empty(), !software };
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Headless frame times in milliseconds
+    std::vector<float> frame_times;
+    frame_times.reserve(headless_frames);
 
-    unsigned int light_source_vao {};
-    glGenVertexArrays(1, &light_source_vao);
-    glBindVertexArray(light_source_vao);
+    // Render loop
+    if (gl) {
+        gl_state().reset_counters();
+    }
+    while (headless ? std::cmp_less(frame_times.size(), headless_frames) : !glfwWindowShouldClose(window)) {
+        {
+            PROFILE_CPU_ZONE("frame");
+
+            const float current_time { seconds_since_start() };
+            delta_time = current_time - last_frame;
+            last_frame = current_time;
+
+            if (!headless) {
+                PROFILE_CPU_ZONE("input");
+                process_input(window);
+            }
+
+            if (gl) {
+                PROFILE_CPU_ZONE("shader reload");
+                gl->shader_watcher.poll();
+            }
+
+            constexpr glm::vec3 clear_color { 0.0f, 0.0f, 0.0f };
+            if (rasterizer) {
+                rasterizer->clear(clear_color);
+            } else {
+                glClearColor(clear_color.r, clear_color.g, clear_color.b, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
+
+            // View and projection, cached by the camera until it changes
+            constexpr float aspect_ratio { static_cast<float>(window_width) / window_height };
+            constexpr float near_plane { 0.1f };
+            constexpr float far_plane { 100.0f };
+            camera.set_perspective(aspect_ratio, near_plane, far_plane);
+            const glm::mat4& view { camera.get_view_matrix() };
+            const glm::mat4& projection { camera.get_projection_matrix() };
+            if (rasterizer) {
+                rasterizer->set_view_projection(projection * view);
+            }
+
+            // Culling
+            {
+                PROFILE_CPU_ZONE("culling");
+                PROFILE_GPU_ZONE(profiler, "culling");
+                const Frustum& frustum { camera.get_frustum() };
+                if (gl) {
+                    gl->gpu_culling.cull(frustum);
+                } else {
+                    cull_spheres(frustum, cube_bounds, visible_cubes);
+                }
+                cull_spheres(frustum, light_source_bounds, visible_light_sources);
+            }
+
+            // Per frame and per object data, written for the whole frame before
+            // drawing
+            FrameAllocator::Slice light_source_data {};
+            if (gl) {
+                gl->frame_allocator.begin_frame();
+                {
+                    PROFILE_CPU_ZONE("frame uniform upload");
+                    const FrameUniforms frame_uniforms {
+                        .view = view,
+                        .projection = projection,
+                        .viewport = glm::vec4 {
+                            window_width, window_height, 1.0f / window_width, 1.0f / window_height
+                        },
+                        .time = current_time,
+                        .padding = {}
+                    };
+                    gl->frame_allocator.bind(gl->frame_allocator.push(frame_uniforms),
+                        GL_UNIFORM_BUFFER, frame_uniform_binding);
+                }
+                if (!visible_light_sources.empty()) {
+                    PROFILE_CPU_ZONE("object data upload");
+                    light_source_data = gl->frame_allocator.push(light_source_model);
+                }
+
+                {
+                    PROFILE_CPU_ZONE("uniform upload");
+                    gl->shader.set_vec3(gl->object_color_uniform, object_color);
+                    gl->shader.set_vec3(gl->light_color_uniform, light_color);
+                }
+            }
+
+            {
+                PROFILE_CPU_ZONE("draw cubes");
+                PROFILE_GPU_ZONE(profiler, "draw cubes");
+                if (gl) {
+                    gl->shader.use();
+                    gl->gpu_culling.draw(gl->mesh_pool);
+                } else if (!visible_cubes.empty()) {
+                    visible_cube_models.clear();
+                    for (const std::uint32_t cube : visible_cubes) {
+                        visible_cube_models.push_back(cube_models[cube]);
+                    }
+                    draw_queue.push(DrawQueue::Draw {
+                        .pass = DrawQueue::Pass::OPAQUE,
+                        .program = 0,
+                        .material = cube_material,
+                        .textures = {},
+                        .vertex_array = 0,
+                        .depth = 0.0f,
+                        .mode = GL_TRIANGLES,
+                        .index_count = static_cast<GLsizei>(cube_mesh.index_count),
+                        .index_type = cube_mesh.index_type,
+                        .index_offset = 0,
+                        .base_vertex = 0,
+                        .instance_count = static_cast<GLsizei>(visible_cube_models.size()),
+                        .object_buffer = 0,
+                        .object_offset = 0,
+                        .object_size = 0,
+                        .mesh = &cube_mesh,
+                        .models = visible_cube_models
+                    });
+                }
+            }
+
+            if (!visible_light_sources.empty()) {
+                PROFILE_CPU_ZONE("queue light source");
+                const glm::vec3 view_pos { view * glm::vec4 { light_pos, 1.0f } };
+                draw_queue.push(DrawQueue::Draw {
+                    .pass = DrawQueue::Pass::OPAQUE,
+                    .program = gl ? gl->light_source_shader.id() : 0,
+                    .material = light_source_material,
+                    .textures = {},
+                    .vertex_array = gl ? gl->mesh_pool.vertex_array() : 0,
+                    .depth = -view_pos.z / far_plane,
+                    .mode = GL_TRIANGLES,
+                    .index_count = static_cast<GLsizei>(cube_mesh.index_count),
+                    .index_type = gl ? MeshPool::index_type : cube_mesh.index_type,
+                    .index_offset = gl ? gl->cube_range.first_index * sizeof(std::uint32_t) : 0,
+                    .base_vertex = gl ? gl->cube_range.base_vertex : 0,
+                    .instance_count = 1,
+                    .object_buffer = gl ? gl->frame_allocator.buffer() : 0,
+                    .object_offset = light_source_data.offset,
+                    .object_size = light_source_data.size,
+                    .mesh = &cube_mesh,
+                    .models = std::span { &light_source_model, 1 }
+                });
+            }
+
+            {
+                PROFILE_CPU_ZONE("draw queue");
+                PROFILE_GPU_ZONE(profiler, "draw queue");
+                draw_queue.submit();
+            }
+
+            if (gl) {
+                gl->frame_allocator.end_frame();
+            }
+
+            if (headless) {
+                // Wait for the frame so the measured time includes rendering.
+                PROFILE_CPU_ZONE("finish");
+                if (rasterizer) {
+                    rasterizer->finish();
+                } else {
+                    glFinish();
+                }
+                frame_times.push_back((seconds_since_start() - current_time) * 1000.0f);
+            } else {
+                PROFILE_CPU_ZONE("swap");
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            }
+        }
+
+        profiler.end_frame();
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, cube_vbo);
-    glVertexAttribPointer(0, elem_count, GL_FLOAT, GL_FALSE, stride, first_value);
-    glEnableVertexAttribArray(0);
+    if (!trace_path.empty()) {
+        profiler.write_chrome_trace(trace_path);
+    }
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    if (headless) {
+        print_frame_times(frame_times);
+    }
 
-    // Shaders
-    Shader shader { "../src/shaders/shader.vert", "../src/shaders/shader.frag" };
-    Shader light_source_shader { "../src/shaders/shader.vert", "../src/shaders/lighting_shader.frag" };
+    if (rasterizer) {
+        dump_frame(*rasterizer, software_image_path);
+    } else if (headless) {
+        const GlState::Counters& state_changes { gl_state().counters() };
+        std::println("state changes per frame: {:.1f} issued, {:.1f} elided",
+            static_cast<double>(state_changes.issued) / frame_times.size(),
+            static_cast<double>(state_changes.elided) / frame_times.size());
 
-    // Render loop
-    while (!glfwWindowShouldClose(window)) {
-        const float current_time { static_cast<float>(glfwGetTime()) };
-        delta_time = current_time - last_frame;
-        last_frame = current_time;
-
-        process_input(window);
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // View
-        const glm::mat4 view { camera.get_view_matrix() };
-
-        // Projection
-        constexpr float aspect_ratio { static_cast<float>(window_width) / window_height };
-        constexpr float near_plane { 0.1f };
-        constexpr float far_plane { 100.0f };
-        const glm::mat4 projection {
-            glm::perspective(camera.get_fov_rad(), aspect_ratio, near_plane, far_plane)
-        };
-
-        // Cube
-        shader.use();
-        shader.set_vec3("object_color", glm::vec3 { 1.0f, 0.5f, 0.31f });
-        shader.set_vec3("light_color", glm::vec3 { 1.0f, 1.0f, 1.0f} );
-        shader.set_mat4("view", view);
-        shader.set_mat4("projection", projection);
-        glm::mat4 cube_model { 1.0f };
-        shader.set_mat4("model", cube_model);
-        glBindVertexArray(cube_vao);
-        glDrawArrays(GL_TRIANGLES, 0, cube_vertices.size());
-
-        // Light source
-        light_source_shader.use();
-        light_source_shader.set_mat4("view", view);
-        light_source_shader.set_mat4("projection", projection);
-        glm::mat4 light_source_model { 1.0f };
-        light_source_model = glm::translate(light_source_model, light_pos);
-        light_source_model = glm::scale(light_source_model, glm::vec3 { 0.2f });
-        light_source_shader.set_mat4("model", light_source_model);
-        glBindVertexArray(light_source_vao);
-        glDrawArrays(GL_TRIANGLES, 0, cube_vertices.size());
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        destroy_headless_context();
     }
 
     quit(0);
@@ -2,6 +2,11 @@
 
 out vec4 frag_color;
 
+#ifdef LIGHT_SOURCE
+void main() {
+    frag_color = vec4(1.0f);
+}
+#else
 uniform vec3 object_color;
 uniform vec3 light_color;
 
@@ -10,3 +15,4 @@ void main() {
     // frag_color = vec4(light_color, 1.0);
     // frag_color = vec4(1.0, 0.0, 0.0, 1.0);
 }
+#endif
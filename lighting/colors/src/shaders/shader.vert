@@ -1,11 +1,14 @@
 #version 460 core
 
+#include "camera.glsl"
+
 layout (location = 0) in vec3 a_pos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// One model per draw of a multi draw, a single draw reads the first.
+layout (std430, binding = 0) readonly buffer Objects {
+    mat4 models[];
+};
 
 void main() {
-   gl_Position = projection * view * model * vec4(a_pos, 1.0f);
+   gl_Position = projection * view * models[gl_DrawID] * vec4(a_pos, 1.0f);
 }